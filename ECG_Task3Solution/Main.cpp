@@ -15,6 +15,7 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <vector>
+#include "MeshOptimizer.h"
 
 // Prototypes 
 void APIENTRY DebugCallback(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, const GLchar* message, const GLvoid* userParam);
@@ -113,6 +114,8 @@ CylinderMesh::CylinderMesh(float radius, float height, float r, float g, float b
 		indices.push_back(3 + i * 2);
 		
 	}
+
+	OptimizeMesh(vertices, 6, indices); // reorder for the post-transform cache and vertex fetch
 }
 
 class Cylinder {
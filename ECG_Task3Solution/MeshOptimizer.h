@@ -0,0 +1,31 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+
+#ifndef  MeshOptimizer_h
+#define MeshOptimizer_h
+
+// average cache miss ratio: vertex shader invocations per triangle for a FIFO post-transform cache
+// with "cacheSize" entries (0.5 is the optimum for large regular grids, 3.0 means no reuse at all)
+float CalculateACMR(const std::vector<unsigned int>& indices, size_t vertexCount, int cacheSize = 16);
+
+// reorders the triangles for post-transform vertex cache locality
+// (Tom Forsyth, "Linear-Speed Vertex Cache Optimisation")
+void OptimizeVertexCache(std::vector<unsigned int>& indices, size_t vertexCount);
+
+// reorders the interleaved vertices ("stride" floats each) in order of first use by the indices,
+// so the vertex fetch walks the vertex buffer linearly. Indices are remapped accordingly
+void OptimizeVertexFetch(std::vector<float>& vertices, int stride, std::vector<unsigned int>& indices);
+
+// what OptimizeMesh did to a mesh
+struct MeshOptimizationStats {
+	size_t triangles;
+	size_t vertices; // after the fetch pass dropped unreferenced ones
+	float acmrBefore;
+	float acmrAfter;
+};
+
+// runs the vertex cache and vertex fetch passes, returns the ACMR before and after
+MeshOptimizationStats OptimizeMesh(std::vector<float>& vertices, int stride, std::vector<unsigned int>& indices);
+
+#endif /MeshOptimizer_h/
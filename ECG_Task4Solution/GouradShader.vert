@@ -3,27 +3,28 @@
 layout (location = 0) in vec3 position;
 layout (location = 1) in vec3 normal;
 
-out vec3 LightingColor; // resulting color from lighting calculations
-uniform vec3 viewPos;
-
-uniform vec3 pLightPosition;
-uniform vec3 pLightColor;
+// per frame camera and light data, written once per frame by the application (std140, binding 0)
+layout (std140, binding = 0) uniform FrameData {
+    mat4 view;
+    mat4 proj;
+    vec3 viewPos;
+    float k_constant;
+    vec3 pLightPosition;
+    float k_linear;
+    vec3 pLightColor;
+    float k_quadratic;
+    vec3 dLightColor;
+    vec3 dLightDirection;
+};
 
-uniform vec3 dLightColor;
-uniform vec3 dLightDirection;
+out vec3 LightingColor; // resulting color from lighting calculations
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 proj;
 
 uniform float k_ambient;
 uniform float k_diffuse;
 uniform float k_specular;
 
-uniform float k_constant;
-uniform float k_linear;
-uniform float k_quadratic;
-
 void main()
 {
 
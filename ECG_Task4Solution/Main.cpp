@@ -795,23 +795,14 @@ OrbitalCamera::OrbitalCamera(glm::vec3 _transformCartesian, float _orbitalRadius
 class Shader {
 public:
 	GLuint program;
-	GLint view;
-	GLint proj;
 	GLint model;
 	GLint materialColor;
 	GLint pointLightColor;
-	GLint pointLightPosition;
-	GLint viewPosition;
 	GLint k_ambient;
 	GLint k_diffuse;
 	GLint k_specular;
 	GLint vertexPositions;
 	GLint vertexNormals;
-	GLint directionalLightColor;
-	GLint directionalLightDirection;
-	GLint k_constant;
-	GLint k_linear;
-	GLint k_quadratic;
 	Shader::Shader(string relativePathVert, string relativePathFrag, string type);
 
 
@@ -898,30 +889,17 @@ Shader::Shader(string relativePathVert, string relativePathFrag, string type) {
 #endif
 
 		// get shader program uniform/attribute IDs
-	view = glGetUniformLocation(program, "view"); // get uniform ID for view matrix
-	proj = glGetUniformLocation(program, "proj"); // get uniform ID for projection matrix 
 	model = glGetUniformLocation(program, "model"); // get uniform ID for model matrix
 
 	vertexPositions = glGetAttribLocation(program, "position"); // get attribute ID for vertex position
 
 	if (type == "phong" || "gourad") {
 		materialColor = glGetUniformLocation(program, "materialColor"); // get uniform ID for out-color vector
-		viewPosition = glGetUniformLocation(program, "viewPos"); // get uniform ID for 
-
-		pointLightPosition = glGetUniformLocation(program, "pLightPosition"); // get uniform ID for 
-		pointLightColor = glGetUniformLocation(program, "pLightColor"); // get uniform ID for 
-
-		directionalLightColor = glGetUniformLocation(program, "dLightColor"); // get uniform ID for 
-		directionalLightDirection = glGetUniformLocation(program, "dLightDirection"); // get uniform ID for 
 
 		k_ambient = glGetUniformLocation(program, "k_ambient"); // get uniform ID for 
 		k_diffuse = glGetUniformLocation(program, "k_diffuse"); // get uniform ID for 
 		k_specular = glGetUniformLocation(program, "k_specular"); // get uniform ID for 
 
-		k_linear= glGetUniformLocation(program, "k_linear"); // get uniform ID for 
-		k_constant = glGetUniformLocation(program, "k_constant"); // get uniform ID for 
-		k_quadratic = glGetUniformLocation(program, "k_quadratic"); // get uniform ID for 
-
 		vertexNormals = glGetAttribLocation(program, "normal"); // get attribute ID for vertex position
 	}
 	if (type == "basic") {
@@ -930,6 +908,60 @@ Shader::Shader(string relativePathVert, string relativePathFrag, string type) {
 
 }
 
+// CPU side mirror of the std140 FrameData block of the shaders, every vec3 is followed by a float or padding to fill its 16 byte slot
+struct FrameData {
+	glm::mat4 view;
+	glm::mat4 proj;
+	glm::vec3 viewPos;
+	float k_constant;
+	glm::vec3 pLightPosition;
+	float k_linear;
+	glm::vec3 pLightColor;
+	float k_quadratic;
+	glm::vec3 dLightColor;
+	float padding0;
+	glm::vec3 dLightDirection;
+	float padding1;
+};
+static_assert(sizeof(FrameData) == 208, "FrameData has to match the std140 layout of the shader block");
+
+// uniform buffer holding the camera and light data shared by every program and draw of a frame, bound to binding 0
+class FrameUniformBuffer {
+public:
+	GLuint Ubo; // uniform buffer object
+	FrameUniformBuffer::FrameUniformBuffer(); // creates and binds the buffer, needs a current GL context
+	void FrameUniformBuffer::Update(glm::mat4 viewMatrix, OrbitalCamera camera, PointLightSource pLightSource, DirectionalLightSource dLightSource); // writes this frame's data
+};
+
+FrameUniformBuffer::FrameUniformBuffer() {
+	glGenBuffers(1, &Ubo); // generate the UBO
+	glBindBuffer(GL_UNIFORM_BUFFER, Ubo);
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameData), nullptr, GL_DYNAMIC_DRAW); // rewritten every frame
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	glBindBufferBase(GL_UNIFORM_BUFFER, 0, Ubo); // every program reads FrameData from binding 0
+}
+
+void FrameUniformBuffer::Update(glm::mat4 viewMatrix, OrbitalCamera camera, PointLightSource pLightSource, DirectionalLightSource dLightSource) {
+	FrameData data;
+	data.view = viewMatrix;
+	data.proj = camera.projectionMatrix;
+	data.viewPos = camera.cameraPosition;
+	data.k_constant = pLightSource.attenuation_Constant;
+	data.pLightPosition = pLightSource.position;
+	data.k_linear = pLightSource.attenuation_Linear;
+	data.pLightColor = pLightSource.color;
+	data.k_quadratic = pLightSource.attenuation_Quadratic;
+	data.dLightColor = dLightSource.color;
+	data.padding0 = 0.0f;
+	data.dLightDirection = dLightSource.direction;
+	data.padding1 = 0.0f;
+
+	glBindBuffer(GL_UNIFORM_BUFFER, Ubo);
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameData), nullptr, GL_DYNAMIC_DRAW); // orphan, the previous frame may still read the old storage
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameData), &data);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
 struct Vectors { // Shorthand representation of 3D vectors in this engine
 	glm::vec3 UP = glm::vec3(0.0f, 1.0f, 0.0f);
 	glm::vec3 DOWN = glm::vec3(0.0f, -1.0f, 0.0f);
@@ -960,32 +992,17 @@ struct InputManager {
 	bool D_KEY_PRESSED = false;
 };
 
-void RenderCuboid(Cuboid object, Shader shader, glm::mat4 viewMatrix, OrbitalCamera camera, PointLightSource pLightSource, DirectionalLightSource dLightSource) {
-	/////DRAW cuboid1 with phong shader
+void RenderCuboid(Cuboid object, Shader shader) {
+	/////DRAW cuboid1 with phong shader, camera and lights come from the FrameData uniform buffer
 	glUseProgram(shader.program); // Load the shader into the rendering pipeline 
 
-	glUniformMatrix4fv(shader.view, 1, GL_FALSE, glm::value_ptr(viewMatrix)); // push view matrix to shader
-	glUniformMatrix4fv(shader.proj, 1, GL_FALSE, glm::value_ptr(camera.projectionMatrix)); // push projection matrix to shader
 	glUniformMatrix4fv(shader.model, 1, GL_FALSE, glm::value_ptr(glm::mat4(1.0f))); // push default model matrix to shader
 
-	glUniform3f(shader.viewPosition, camera.cameraPosition.x, camera.cameraPosition.y, camera.cameraPosition.z); // push color to shader
-
 	glBindVertexArray(object.Vao); //  bind cuboid VAO
 
 	glUniformMatrix4fv(shader.model, 1, GL_FALSE, glm::value_ptr(object.transform)); // push cuboid transform to shader
 	glUniform3f(shader.materialColor, object.material.baseColor.r, object.material.baseColor.g, object.material.baseColor.b); // push color to shader
 
-	glUniform1f(shader.k_constant, pLightSource.attenuation_Constant);
-	glUniform1f(shader.k_linear, pLightSource.attenuation_Linear);
-	glUniform1f(shader.k_quadratic, pLightSource.attenuation_Quadratic);
-	glm::vec3 energy = glm::vec3(pLightSource.color.x, pLightSource.color.y, pLightSource.color.z);
-
-	glUniform3f(shader.pointLightColor, energy.x, energy.y, energy.z); // push color to shader
-	glUniform3f(shader.pointLightPosition, pLightSource.position.x, pLightSource.position.y, pLightSource.position.z); // push color to shader
-
-	glUniform3f(shader.directionalLightColor, dLightSource.color.x, dLightSource.color.y, dLightSource.color.z); // push color to shader
-	glUniform3f(shader.directionalLightDirection, dLightSource.direction.x, dLightSource.direction.y, dLightSource.direction.z); // push color to shader
-
 	glUniform1f(shader.k_ambient, object.material.k_ambient);
 	glUniform1f(shader.k_diffuse, object.material.k_diffuse);
 	glUniform1f(shader.k_specular, object.material.k_specular);
@@ -994,33 +1011,18 @@ void RenderCuboid(Cuboid object, Shader shader, glm::mat4 viewMatrix, OrbitalCam
 	glBindVertexArray(0); // unbind VAO
 }
 
-void RenderSphere(Sphere object, Shader shader, glm::mat4 viewMatrix, OrbitalCamera camera, PointLightSource pLightSource, DirectionalLightSource dLightSource) {
+void RenderSphere(Sphere object, Shader shader) {
 	/////DRAW cylinder1 with phong shader
 
 	glUseProgram(shader.program); // Load the shader into the rendering pipeline 
 
-	glUniformMatrix4fv(shader.view, 1, GL_FALSE, glm::value_ptr(viewMatrix)); // push view matrix to shader
-	glUniformMatrix4fv(shader.proj, 1, GL_FALSE, glm::value_ptr(camera.projectionMatrix)); // push projection matrix to shader
 	glUniformMatrix4fv(shader.model, 1, GL_FALSE, glm::value_ptr(glm::mat4(1.0f))); // push default model matrix to shader
 
-	glUniform3f(shader.viewPosition, camera.cameraPosition.x, camera.cameraPosition.y, camera.cameraPosition.z); // push color to shader
-
 	glBindVertexArray(object.Vao); //  bind cuboid VAO
 
 	glUniformMatrix4fv(shader.model, 1, GL_FALSE, glm::value_ptr(object.transform)); // push cuboid transform to shader
 	glUniform3f(shader.materialColor, object.material.baseColor.r, object.material.baseColor.g, object.material.baseColor.b); // push color to shader
 
-	glUniform1f(shader.k_constant, pLightSource.attenuation_Constant);
-	glUniform1f(shader.k_linear, pLightSource.attenuation_Linear);
-	glUniform1f(shader.k_quadratic, pLightSource.attenuation_Quadratic);
-	glm::vec3 energy = glm::vec3(pLightSource.color.x, pLightSource.color.y, pLightSource.color.z);
-
-	glUniform3f(shader.pointLightColor, energy.x, energy.y, energy.z); // push color to shader
-	glUniform3f(shader.pointLightPosition, pLightSource.position.x, pLightSource.position.y, pLightSource.position.z); // push color to shader
-
-	glUniform3f(shader.directionalLightColor, dLightSource.color.x, dLightSource.color.y, dLightSource.color.z); // push color to shader
-	glUniform3f(shader.directionalLightDirection, dLightSource.direction.x, dLightSource.direction.y, dLightSource.direction.z); // push color to shader
-
 	glUniform1f(shader.k_ambient, object.material.k_ambient);
 	glUniform1f(shader.k_diffuse, object.material.k_diffuse);
 	glUniform1f(shader.k_specular, object.material.k_specular);
@@ -1030,32 +1032,17 @@ void RenderSphere(Sphere object, Shader shader, glm::mat4 viewMatrix, OrbitalCam
 
 }
 
-void RenderCylinder(Cylinder object, Shader shader, glm::mat4 viewMatrix, OrbitalCamera camera, PointLightSource pLightSource, DirectionalLightSource dLightSource) {
+void RenderCylinder(Cylinder object, Shader shader) {
 	/////DRAW cylinder1 with phong shader
 	glUseProgram(shader.program); // Load the shader into the rendering pipeline 
 
-	glUniformMatrix4fv(shader.view, 1, GL_FALSE, glm::value_ptr(viewMatrix)); // push view matrix to shader
-	glUniformMatrix4fv(shader.proj, 1, GL_FALSE, glm::value_ptr(camera.projectionMatrix)); // push projection matrix to shader
 	glUniformMatrix4fv(shader.model, 1, GL_FALSE, glm::value_ptr(glm::mat4(1.0f))); // push default model matrix to shader
 
-	glUniform3f(shader.viewPosition, camera.cameraPosition.x, camera.cameraPosition.y, camera.cameraPosition.z); // push color to shader
-
 	glBindVertexArray(object.Vao); //  bind cuboid VAO
 
 	glUniformMatrix4fv(shader.model, 1, GL_FALSE, glm::value_ptr(object.transform)); // push cuboid transform to shader
 	glUniform3f(shader.materialColor, object.material.baseColor.r, object.material.baseColor.g, object.material.baseColor.b); // push color to shader
 
-	glUniform1f(shader.k_constant, pLightSource.attenuation_Constant);
-	glUniform1f(shader.k_linear, pLightSource.attenuation_Linear);
-	glUniform1f(shader.k_quadratic, pLightSource.attenuation_Quadratic);
-	glm::vec3 energy = glm::vec3(pLightSource.color.x, pLightSource.color.y, pLightSource.color.z);
-
-	glUniform3f(shader.pointLightColor, energy.x, energy.y, energy.z); // push color to shader
-	glUniform3f(shader.pointLightPosition, pLightSource.position.x, pLightSource.position.y, pLightSource.position.z); // push color to shader
-
-	glUniform3f(shader.directionalLightColor, dLightSource.color.x, dLightSource.color.y, dLightSource.color.z); // push color to shader
-	glUniform3f(shader.directionalLightDirection, dLightSource.direction.x, dLightSource.direction.y, dLightSource.direction.z); // push color to shader
-
 	glUniform1f(shader.k_ambient, object.material.k_ambient);
 	glUniform1f(shader.k_diffuse, object.material.k_diffuse);
 	glUniform1f(shader.k_specular, object.material.k_specular);
@@ -1064,12 +1051,10 @@ void RenderCylinder(Cylinder object, Shader shader, glm::mat4 viewMatrix, Orbita
 	glBindVertexArray(0); // unbind VAO
 }
 
-void RenderPointLightSource(PointLightSource pLightSource, Shader shader, glm::mat4 viewMatrix, OrbitalCamera camera) {
+void RenderPointLightSource(PointLightSource pLightSource, Shader shader) {
 	//////// draw light source with basic shader
 	glUseProgram(shader.program); // Load the shader into the rendering pipeline 
 
-	glUniformMatrix4fv(shader.view, 1, GL_FALSE, glm::value_ptr(viewMatrix)); // push view matrix to shader
-	glUniformMatrix4fv(shader.proj, 1, GL_FALSE, glm::value_ptr(camera.projectionMatrix)); // push projection matrix to shader
 	glUniformMatrix4fv(shader.model, 1, GL_FALSE, glm::value_ptr(glm::mat4(1.0f))); // push default model matrix to shader
 
 	glBindVertexArray(pLightSource.Vao);
@@ -1262,6 +1247,8 @@ int main(int argc, char** argv)
 
 	glEnable(GL_DEPTH_TEST); // enable Z-Depth buffer system
 
+	FrameUniformBuffer frameUniforms; // camera and light data of the frame, bound to the FrameData block of every program
+
 	// render loop
 	while (!glfwWindowShouldClose(window)) // render loop
 	{
@@ -1384,11 +1371,13 @@ int main(int argc, char** argv)
 
 			glFrontFace(GL_CCW);		// counter clockwise
 
-			//RenderPointLightSource(pointLightSource, basicShader, viewMatrix, mainCamera);
-			RenderCuboid(cuboid, phongShader, viewMatrix, mainCamera, pointLightSource, directionalLightSource);
-			RenderCylinder(cylinder, phongShader, viewMatrix, mainCamera, pointLightSource, directionalLightSource);
-			RenderSphere(sphere, phongShader, viewMatrix, mainCamera, pointLightSource, directionalLightSource);
-			RenderSphere(sphere2, gouradShader, viewMatrix, mainCamera, pointLightSource, directionalLightSource);
+			frameUniforms.Update(viewMatrix, mainCamera, pointLightSource, directionalLightSource); // one upload for every program and draw of the frame
+
+			//RenderPointLightSource(pointLightSource, basicShader);
+			RenderCuboid(cuboid, phongShader);
+			RenderCylinder(cylinder, phongShader);
+			RenderSphere(sphere, phongShader);
+			RenderSphere(sphere2, gouradShader);
 
 			glfwSwapBuffers(window); // swap buffer
 		}
@@ -1402,6 +1391,8 @@ int main(int argc, char** argv)
 
 	glDeleteProgram(basicShader.program);
 
+	glDeleteBuffers(1, &frameUniforms.Ubo);
+
 	glDeleteBuffers(1, &cuboid.Vbo);
 	glDeleteBuffers(1, &cuboid.Ebo);
 	glDeleteVertexArrays(1, &cuboid.Vao);
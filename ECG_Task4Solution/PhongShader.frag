@@ -1,29 +1,31 @@
 //fragment shader
 #version 430
 
+// per frame camera and light data, written once per frame by the application (std140, binding 0)
+layout (std140, binding = 0) uniform FrameData {
+    mat4 view;
+    mat4 proj;
+    vec3 viewPos;
+    float k_constant;
+    vec3 pLightPosition;
+    float k_linear;
+    vec3 pLightColor;
+    float k_quadratic;
+    vec3 dLightColor;
+    vec3 dLightDirection;
+};
+
 out vec4 FragColor;
 
 in vec3 Normal;
 in vec3 FragPos;
 
 uniform vec3 materialColor;
-uniform vec3 viewPos;
-
-uniform vec3 pLightColor;
-uniform vec3 pLightPosition;
-
-uniform vec3 dLightColor;
-uniform vec3 dLightDirection;
 
 uniform float k_ambient;
 uniform float k_diffuse;
 uniform float k_specular;
 
-uniform float k_constant;
-uniform float k_linear;
-uniform float k_quadratic;
-
-
 void main()
 {
     vec3 result;
@@ -3,9 +3,21 @@
 layout (location = 0) in vec3 position;
 layout (location = 1) in vec3 normal;
 
+// per frame camera and light data, written once per frame by the application (std140, binding 0)
+layout (std140, binding = 0) uniform FrameData {
+    mat4 view;
+    mat4 proj;
+    vec3 viewPos;
+    float k_constant;
+    vec3 pLightPosition;
+    float k_linear;
+    vec3 pLightColor;
+    float k_quadratic;
+    vec3 dLightColor;
+    vec3 dLightDirection;
+};
+
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 proj;
 
 out vec3 Normal;
 out vec3 FragPos;
@@ -2,11 +2,11 @@
 #version 430
 layout (location = 0) in vec3 position;
 
+#include "FrameData.glsl"
+
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 proj;
 
 void main()
 {
-    gl_Position = proj* view * model * vec4(position, 1.0);
+    gl_Position = proj * (view * (model * vec4(position, 1.0))); // matrix times vector only, no per vertex matrix products
 } 
\ No newline at end of file
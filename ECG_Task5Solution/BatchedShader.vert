@@ -0,0 +1,40 @@
+//vertex shader of the multi-draw path, per object data comes from the ObjectBuffer entry of the draw
+#version 430
+#extension GL_ARB_shader_draw_parameters : enable
+layout (location = 0) in vec3 position;
+layout (location = 1) in vec3 normal;
+layout (location = 2) in vec2 uv;
+
+#include "FrameData.glsl"
+#include "ObjectData.glsl"
+
+uniform int drawOffset = 0; // first command of the current glMultiDrawElementsIndirect call
+
+#ifdef GL_ARB_shader_draw_parameters
+#define DRAW_ID gl_DrawIDARB
+#else
+#define DRAW_ID 0 // the application only takes this path with GL_ARB_shader_draw_parameters
+#endif
+
+out vec3 Normal;
+out vec3 FragPos;
+out vec2 Uv;
+flat out int ObjectIndex;
+
+#include "Octahedral.glsl"
+
+invariant gl_Position; // the depth pre-pass runs this shader too, GL_EQUAL needs bit identical depth in both passes
+
+void main()
+{
+    ObjectIndex = drawOffset + DRAW_ID;
+    ObjectData object = objects[ObjectIndex];
+
+    vec3 objectPosition = object.positionOffset.xyz + position * object.positionScale.xyz;
+    vec3 objectNormal = object.octahedralNormals != 0 ? DecodeOctahedral(normal.xy) : normal;
+
+    gl_Position = objectMvps[ObjectIndex] * vec4(objectPosition, 1.0); // computed once per object on the CPU
+    FragPos = vec3(object.model * vec4(objectPosition, 1.0));
+    Normal = object.normalMatrix * objectNormal;
+    Uv = (object.uvOffset + uv * object.uvScale) * object.textureScale;
+}
@@ -0,0 +1,57 @@
+#include "BoundingVolume.h"
+#include <cmath>
+#include <algorithm>
+
+BoundingVolume MakeBounds(glm::vec3 min, glm::vec3 max) {
+	BoundingVolume bounds;
+	bounds.min = min;
+	bounds.max = max;
+	bounds.center = (min + max) * 0.5f;
+	bounds.radius = glm::length(max - bounds.center);
+	return bounds;
+}
+
+BoundingVolume ComputeBounds(const float* vertices, size_t vertexCount, size_t stride) {
+	if (vertexCount == 0) {
+		return MakeBounds(glm::vec3(0.0f), glm::vec3(0.0f));
+	}
+
+	glm::vec3 min = glm::vec3(vertices[0], vertices[1], vertices[2]);
+	glm::vec3 max = min;
+	for (size_t i = 1; i < vertexCount; i++) {
+		const float* p = vertices + i * stride;
+		min = glm::min(min, glm::vec3(p[0], p[1], p[2]));
+		max = glm::max(max, glm::vec3(p[0], p[1], p[2]));
+	}
+
+	BoundingVolume bounds = MakeBounds(min, max);
+	float radiusSquared = 0.0f;
+	for (size_t i = 0; i < vertexCount; i++) {
+		const float* p = vertices + i * stride;
+		glm::vec3 d = glm::vec3(p[0], p[1], p[2]) - bounds.center;
+		radiusSquared = std::max(radiusSquared, glm::dot(d, d));
+	}
+	bounds.radius = std::sqrt(radiusSquared);
+	return bounds;
+}
+
+BoundingVolume TransformBounds(const BoundingVolume& bounds, const glm::mat4& transform) {
+	BoundingVolume result;
+
+	// box: transformed center plus the extent projected onto each world axis (Arvo)
+	glm::vec3 boxCenter = glm::vec3(transform * glm::vec4((bounds.min + bounds.max) * 0.5f, 1.0f));
+	glm::vec3 extent = (bounds.max - bounds.min) * 0.5f;
+	glm::vec3 worldExtent = glm::vec3(0.0f);
+	for (int column = 0; column < 3; column++) {
+		for (int row = 0; row < 3; row++) {
+			worldExtent[row] += std::abs(transform[column][row]) * extent[column];
+		}
+	}
+	result.min = boxCenter - worldExtent;
+	result.max = boxCenter + worldExtent;
+
+	float scale = std::max(glm::length(glm::vec3(transform[0])), std::max(glm::length(glm::vec3(transform[1])), glm::length(glm::vec3(transform[2]))));
+	result.center = glm::vec3(transform * glm::vec4(bounds.center, 1.0f));
+	result.radius = bounds.radius * scale;
+	return result;
+}
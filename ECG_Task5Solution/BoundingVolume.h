@@ -0,0 +1,27 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <cstddef>
+
+#ifndef  BoundingVolume_h
+#define BoundingVolume_h
+
+// bounding sphere and axis aligned box of a mesh or object, both in the same space
+struct BoundingVolume {
+	glm::vec3 center; // sphere center
+	float radius;
+	glm::vec3 min; // box corners
+	glm::vec3 max;
+};
+
+// sphere and box of a box, the sphere is the one around the box
+BoundingVolume MakeBounds(glm::vec3 min, glm::vec3 max);
+
+// bounds of "vertexCount" interleaved vertices, the position is the first three floats of every "stride" floats.
+// The sphere is centered on the box and reaches the farthest vertex, which is tighter than the box sphere for round meshes
+BoundingVolume ComputeBounds(const float* vertices, size_t vertexCount, size_t stride);
+
+// bounds of "bounds" after "transform": the box is the box around the transformed box,
+// the sphere radius grows with the largest axis scale
+BoundingVolume TransformBounds(const BoundingVolume& bounds, const glm::mat4& transform);
+
+#endif /BoundingVolume_h/
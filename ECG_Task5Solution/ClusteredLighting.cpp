@@ -0,0 +1,132 @@
+#include "ClusteredLighting.h"
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <glm/gtc/type_ptr.hpp>
+#include "ComputeProgram.h"
+#include "GLStateCache.h"
+
+const GLuint kBinGroupSize = 64; // local_size_x of LightClusters.comp
+
+float PointLightRange(const glm::vec3& color, float constant, float linear, float quadratic) {
+	float intensity = std::max(color.r, std::max(color.g, color.b));
+	float reach = intensity / kLightCutoff - constant; // solve quadratic * d^2 + linear * d = intensity / cutoff - constant
+	if (reach <= 0.0f) {
+		return 0.0f; // never brighter than the cutoff
+	}
+	if (quadratic > 0.0f) {
+		return (-linear + std::sqrt(linear * linear + 4.0f * quadratic * reach)) / (2.0f * quadratic);
+	}
+	if (linear > 0.0f) {
+		return reach / linear;
+	}
+	return std::numeric_limits<float>::max(); // no falloff, in every froxel
+}
+
+ClusteredLights::ClusteredLights(int _capacity, int _viewportWidth, int _viewportHeight) {
+	capacity = _capacity;
+	viewportWidth = _viewportWidth;
+	viewportHeight = _viewportHeight;
+	grid = glm::uvec4(kClusterGridX, kClusterGridY, kClusterGridZ, kMaxLightsPerCluster);
+	scale = glm::vec4(0.0f);
+
+	GLint alignment = 1;
+	glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &alignment);
+	arrayStride = (GLsizeiptr)std::max(capacity, 1) * sizeof(glm::vec4);
+	arrayStride = (arrayStride + alignment - 1) / alignment * alignment;
+
+	glGenBuffers(1, &lightBuffer);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, lightBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, 3 * arrayStride, nullptr, GL_DYNAMIC_DRAW);
+	glGenBuffers(1, &clusterBuffer);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, clusterBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, (GLsizeiptr)kClusterGridX * kClusterGridY * kClusterGridZ * (kMaxLightsPerCluster + 1) * sizeof(GLuint), nullptr, GL_DYNAMIC_COPY); // written and read by the GPU only
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+	binProgram = LoadComputeProgram("assets/LightClusters.comp");
+	viewLocation = glGetUniformLocation(binProgram, "view");
+	clusterGridLocation = glGetUniformLocation(binProgram, "clusterGrid");
+	projectionScaleLocation = glGetUniformLocation(binProgram, "projectionScale");
+	zNearLocation = glGetUniformLocation(binProgram, "zNear");
+	zFarLocation = glGetUniformLocation(binProgram, "zFar");
+	lightCountLocation = glGetUniformLocation(binProgram, "lightCount");
+
+	dirty = false;
+}
+
+unsigned int ClusteredLights::Add(const glm::vec3& position, const glm::vec3& color, float constant, float linear, float quadratic) {
+	if ((int)positionRanges.size() >= capacity) {
+		return kInvalidLight; // full, the light is dropped
+	}
+	positionRanges.push_back(glm::vec4(position, PointLightRange(color, constant, linear, quadratic)));
+	colors.push_back(glm::vec4(color, 1.0f));
+	attenuations.push_back(glm::vec4(constant, linear, quadratic, 0.0f));
+	dirty = true;
+	return (unsigned int)(positionRanges.size() - 1);
+}
+
+void ClusteredLights::Move(unsigned int index, const glm::vec3& position) {
+	if (index >= positionRanges.size()) {
+		return; // kInvalidLight, the light was never added
+	}
+	glm::vec4& positionRange = positionRanges[index];
+	if (positionRange.x != position.x || positionRange.y != position.y || positionRange.z != position.z) {
+		positionRange = glm::vec4(position, positionRange.w);
+		dirty = true;
+	}
+}
+
+unsigned int ClusteredLights::Count() const {
+	return (unsigned int)positionRanges.size();
+}
+
+void ClusteredLights::Upload() {
+	GLsizeiptr arrayBytes = (GLsizeiptr)positionRanges.size() * sizeof(glm::vec4);
+	if (dirty && arrayBytes > 0) {
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, lightBuffer);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, 3 * arrayStride, nullptr, GL_DYNAMIC_DRAW); // orphan, the previous frame may still read the old storage
+		glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, arrayBytes, &positionRanges[0]);
+		glBufferSubData(GL_SHADER_STORAGE_BUFFER, arrayStride, arrayBytes, &colors[0]);
+		glBufferSubData(GL_SHADER_STORAGE_BUFFER, 2 * arrayStride, arrayBytes, &attenuations[0]);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	}
+	dirty = false;
+
+	GLsizeiptr boundBytes = std::max(arrayBytes, (GLsizeiptr)sizeof(glm::vec4)); // a range may not be empty
+	glBindBufferRange(GL_SHADER_STORAGE_BUFFER, kLightPositionBinding, lightBuffer, 0, boundBytes);
+	glBindBufferRange(GL_SHADER_STORAGE_BUFFER, kLightColorBinding, lightBuffer, arrayStride, boundBytes);
+	glBindBufferRange(GL_SHADER_STORAGE_BUFFER, kLightAttenuationBinding, lightBuffer, 2 * arrayStride, boundBytes);
+}
+
+void ClusteredLights::Bin(const glm::mat4& viewMatrix, const glm::mat4& projection) {
+	Upload();
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, kLightClusterBinding, clusterBuffer);
+
+	// near and far of a glm::perspective matrix, the froxel slices are spaced exponentially between them
+	float zNear = projection[3][2] / (projection[2][2] - 1.0f);
+	float zFar = projection[3][2] / (projection[2][2] + 1.0f);
+	float logDepthRange = std::log(zFar / zNear);
+	scale = glm::vec4(
+		(float)grid.x / viewportWidth,
+		(float)grid.y / viewportHeight,
+		(float)grid.z / logDepthRange,
+		-(float)grid.z * std::log(zNear) / logDepthRange
+	);
+
+	CachedUseProgram(binProgram);
+	glUniformMatrix4fv(viewLocation, 1, GL_FALSE, glm::value_ptr(viewMatrix));
+	glUniform4ui(clusterGridLocation, grid.x, grid.y, grid.z, grid.w);
+	glUniform2f(projectionScaleLocation, 1.0f / projection[0][0], 1.0f / projection[1][1]); // view space x and y per unit of depth at the frustum edge
+	glUniform1f(zNearLocation, zNear);
+	glUniform1f(zFarLocation, zFar);
+	glUniform1ui(lightCountLocation, (GLuint)positionRanges.size());
+	GLuint clusterCount = grid.x * grid.y * grid.z;
+	glDispatchCompute((clusterCount + kBinGroupSize - 1) / kBinGroupSize, 1, 1);
+	glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT); // the fragment shaders read the lists
+}
+
+void ClusteredLights::Release() {
+	glDeleteProgram(binProgram);
+	glDeleteBuffers(1, &lightBuffer);
+	glDeleteBuffers(1, &clusterBuffer);
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <GL\glew.h>
+#include <glm/glm.hpp>
+#include <vector>
+
+#ifndef  ClusteredLighting_h
+#define ClusteredLighting_h
+
+// shader storage bindings of the light data, ObjectData and the GPU cull pass use 1 to 5
+const GLuint kLightPositionBinding = 6; // vec4 per light, world position and range
+const GLuint kLightColorBinding = 7; // vec4 per light, rgb
+const GLuint kLightAttenuationBinding = 8; // vec4 per light, constant, linear and quadratic attenuation
+const GLuint kLightClusterBinding = 9; // per froxel the light count followed by kMaxLightsPerCluster light indices
+
+// froxel grid over the view frustum, x and y split the viewport, z is exponential between near and far
+const int kClusterGridX = 16;
+const int kClusterGridY = 9;
+const int kClusterGridZ = 24;
+const int kMaxLightsPerCluster = 128; // bounds the per fragment cost, further lights of a crowded froxel are dropped
+
+const unsigned int kInvalidLight = 0xFFFFFFFFu; // ClusteredLights::Add when the buffer is full
+
+const float kLightCutoff = 1.0f / 256.0f; // attenuated intensity below which a light no longer contributes
+
+// distance at which a light of "color" attenuated by 1 / (constant + linear * d + quadratic * d * d)
+// falls below kLightCutoff, the shaders fade the light out towards it so froxel borders stay invisible
+float PointLightRange(const glm::vec3& color, float constant, float linear, float quadratic);
+
+// point lights in an SoA shader storage buffer, binned into the froxels of the camera by a compute pass
+// (LightClusters.comp) so the fragment shaders only loop over the lights of their own froxel
+class ClusteredLights {
+public:
+	GLuint lightBuffer; // position/range, color and attenuation arrays of "capacity" entries each, one after another
+	GLuint clusterBuffer; // light lists of the froxels, written by the compute pass
+	int capacity; // maximum number of lights
+	glm::uvec4 grid; // froxels along x, y and z, w = kMaxLightsPerCluster, FrameData.clusterGrid
+	glm::vec4 scale; // froxels per pixel in x and y, slice = log(view depth) * z + w, FrameData.clusterScale
+	ClusteredLights(int capacity, int viewportWidth, int viewportHeight); // needs a current GL context
+	unsigned int Add(const glm::vec3& position, const glm::vec3& color, float constant, float linear, float quadratic); // returns the index of the light, kInvalidLight if the buffer is full
+	void Move(unsigned int index, const glm::vec3& position); // ignores kInvalidLight
+	unsigned int Count() const;
+	void Upload(); // uploads changed lights and binds the light arrays, all the deferred path needs
+	void Bin(const glm::mat4& viewMatrix, const glm::mat4& projection); // Upload and fill the froxel lists, call before drawing
+	void Release();
+private:
+	std::vector<glm::vec4> positionRanges;
+	std::vector<glm::vec4> colors;
+	std::vector<glm::vec4> attenuations;
+	GLsizeiptr arrayStride; // bytes between the arrays in lightBuffer, keeps every array at a legal SSBO offset
+	bool dirty; // lights changed since the last upload
+	int viewportWidth;
+	int viewportHeight;
+	GLuint binProgram;
+	GLint viewLocation;
+	GLint clusterGridLocation;
+	GLint projectionScaleLocation;
+	GLint zNearLocation;
+	GLint zFarLocation;
+	GLint lightCountLocation;
+};
+
+#endif /ClusteredLighting_h/
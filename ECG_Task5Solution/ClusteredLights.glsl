@@ -0,0 +1,32 @@
+//chunk: the froxel light lists LightClusters.comp writes (std430, binding 9)
+#ifndef CLUSTERED_LIGHTS_GLSL
+#define CLUSTERED_LIGHTS_GLSL
+
+#include "FrameData.glsl"
+#include "PointLights.glsl"
+
+layout (std430, binding = 9) readonly buffer LightClusters {
+    uint clusterLights[]; // per froxel the light count followed by clusterGrid.w light indices
+};
+
+// index of the froxel at "tile" (in froxels) and "viewDepth"
+uint ClusterIndex(vec2 tile, float viewDepth)
+{
+    uvec2 cell = uvec2(clamp(ivec2(tile), ivec2(0), ivec2(clusterGrid.xy) - 1));
+    uint slice = uint(clamp(int(log(viewDepth) * clusterScale.z + clusterScale.w), 0, int(clusterGrid.z) - 1));
+    return (slice * clusterGrid.y + cell.y) * clusterGrid.x + cell.x;
+}
+
+// sum of the point lights of "cluster"
+vec3 ClusteredPointLights(uint cluster, vec3 position, vec3 norm, vec3 viewDir, float k_ambient, float k_diffuse, float k_specular, float shininess)
+{
+    vec3 result = vec3(0.0);
+    uint first = cluster * (clusterGrid.w + 1u);
+    uint count = clusterLights[first];
+    for (uint i = 0u; i < count; i++) {
+        result += PointLight(clusterLights[first + 1u + i], position, norm, viewDir, k_ambient, k_diffuse, k_specular, shininess);
+    }
+    return result;
+}
+
+#endif
@@ -0,0 +1,49 @@
+#include "ComputeProgram.h"
+#include <iostream>
+#include <vector>
+#include "ShaderPermutation.h"
+#include "ProgramBinaryCache.h"
+
+GLuint LoadComputeProgram(const std::string& relativePath) {
+	std::vector<std::string> sources(1, AssembleShaderSource(relativePath, 0)); // with the #include chunks spliced in
+	unsigned long long cacheKey = ProgramCacheKey(sources);
+	GLuint program = LoadProgramBinary(cacheKey);
+	if (program != 0) {
+		return program;
+	}
+
+	const char* computeSource = sources[0].c_str();
+	GLuint computeShader = glCreateShader(GL_COMPUTE_SHADER);
+	glShaderSource(computeShader, 1, &computeSource, 0);
+	glCompileShader(computeShader);
+
+	GLint succeded_cs;
+	glGetShaderiv(computeShader, GL_COMPILE_STATUS, &succeded_cs);
+	if (succeded_cs == GL_FALSE) {
+		GLint logSize;
+		glGetShaderiv(computeShader, GL_INFO_LOG_LENGTH, &logSize);
+		GLchar* message = new char[logSize];
+		glGetShaderInfoLog(computeShader, logSize, NULL, message);
+		std::cerr << relativePath << ": " << message;
+		delete[] message;
+	}
+
+	program = glCreateProgram();
+	glAttachShader(program, computeShader);
+	MarkProgramRetrievable(program);
+	glLinkProgram(program);
+	glDeleteShader(computeShader); // stays alive while attached
+
+	GLint isLinked;
+	glGetProgramiv(program, GL_LINK_STATUS, &isLinked);
+	if (isLinked == GL_FALSE) {
+		GLint maxLength;
+		glGetProgramiv(program, GL_INFO_LOG_LENGTH, &maxLength);
+		GLchar* message = new char[maxLength];
+		glGetProgramInfoLog(program, maxLength, &maxLength, message);
+		std::cerr << relativePath << ": " << message;
+		delete[] message;
+	}
+	StoreProgramBinary(program, cacheKey);
+	return program;
+}
@@ -0,0 +1,12 @@
+#pragma once
+#include <GL\glew.h>
+#include <string>
+
+#ifndef  ComputeProgram_h
+#define ComputeProgram_h
+
+// compiles and links the compute shader at "relativePath" (#include chunks allowed, see AssembleShaderSource),
+// or loads it from the program binary cache, compile and link errors go to std::cerr
+GLuint LoadComputeProgram(const std::string& relativePath);
+
+#endif /ComputeProgram_h/
@@ -1,24 +1,33 @@
 #include "Cuboid.h"
-Cuboid::Cuboid(glm::mat4 _transform, glm::vec3 _position, float length, float width, float height, float r, float g, float b, float ka, float kd, float ks, int alpha) {
+Cuboid::Cuboid(glm::mat4 _transform, glm::vec3 _position, float length, float width, float height, float r, float g, float b, float ka, float kd, float ks, int alpha, bool packed) {
 
 	position = _position;
-	transform = glm::translate(_transform, position);
-	mesh = CuboidMesh(length, height, width);
+	transform = glm::scale(glm::translate(_transform, position), glm::vec3(width, length, height)); // the mesh is a unit cube, axes as CuboidMesh(length, height, width) scaled them
 	material = Material(r, g, b, ka, kd, ks, alpha);
 	texture = Texture("assets/textures/wood_texture.dds");
-	glGenVertexArrays(1, &Vao); // create the VAO
-	glBindVertexArray(Vao); // bind the VAO
-	glGenBuffers(1, &Vbo); // generate the VBO
-	glBindBuffer(GL_ARRAY_BUFFER, Vbo); // bind the VBO
-	glBufferData(GL_ARRAY_BUFFER, sizeof(mesh.data), mesh.data, GL_STATIC_DRAW); // buffer the vertex data
+	material.textureLayer = texture.layer; // -1 unless the texture was packed into an array
 
-	// position attribute
-	glEnableVertexAttribArray(0);
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-	// color attribute
-	glEnableVertexAttribArray(1);
-	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
-	// texture coord attribute
-	glEnableVertexAttribArray(2);
-	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
+	GeometryKey key(PRIMITIVE_CUBOID, 1.0f, 1.0f, 1.0f, 0, 0, false, packed);
+	geometry = AcquireGeometry(key, [&](Geometry& shared) { // only built for the first cuboid
+		CuboidMesh mesh; // unit cube
+		shared.bounds = mesh.bounds;
+		UploadVertices(mesh.data, 36, packed, shared.quantization); // buffer the vertex data and set the layout
+		shared.elementCount = 36;
+	});
+	bounds = geometry->bounds;
 }
+
+DrawPacket Cuboid::MakeDrawPacket() const {
+	DrawPacket packet = DrawPacket();
+	packet.texture = texture.Handle();
+	packet.textureTarget = texture.target;
+	packet.geometry = geometry;
+	packet.primitive = PRIMITIVE_CUBOID;
+	packet.transform = &transform;
+	packet.material = &material;
+	return packet;
+}
+
+BoundingVolume Cuboid::WorldBounds() const {
+	return TransformBounds(bounds, transform);
+}
\ No newline at end of file
@@ -5,6 +5,9 @@
 #include <GL\glew.h>
 #include "Material.h"
 #include "Texture.h"
+#include "GeometryRegistry.h"
+#include "RenderQueue.h"
+#include "BoundingVolume.h"
 
 
 #ifndef  Cuboid_h
@@ -12,13 +15,13 @@
 
 class Cuboid {
 public:
-	glm::mat4 transform; // model matrix of the cuboid object
+	glm::mat4 transform; // model matrix of the cuboid object, scales the unit cube to its dimensions
 	glm::vec3 position;
-	CuboidMesh mesh; // mesh object
-	GLuint Vao; // vertex array object
-	GLuint Vbo; // vertex buffer object
-	GLuint Ebo; // element buffer object
-	Cuboid::Cuboid(glm::mat4 transform, glm::vec3 position, float length, float width, float heght, float r, float g, float b, float, float, float, int); // constructor
+	Geometry* geometry; // unit cube VAO/VBO shared with every cuboid
+	BoundingVolume bounds; // object space bounds of the unit cube
+	Cuboid::Cuboid(glm::mat4 transform, glm::vec3 position, float length, float width, float heght, float r, float g, float b, float, float, float, int, bool packed = false); // constructor
+	DrawPacket MakeDrawPacket() const; // draw packet of the cuboid
+	BoundingVolume WorldBounds() const; // bounds transformed by transform
 	Material material;
 	Texture texture;
 };
@@ -1,6 +1,6 @@
 #include "CuboidMesh.h"
 CuboidMesh::CuboidMesh() {
-
+	bounds = ComputeBounds(data, 36, 8); // unit cube
 }
 
 CuboidMesh::CuboidMesh(float length, float width, float height) {
@@ -39,5 +39,5 @@ CuboidMesh::CuboidMesh(float length, float width, float height) {
 		}
 	}
 
-
+	bounds = ComputeBounds(data, 36, 8);
 }
\ No newline at end of file
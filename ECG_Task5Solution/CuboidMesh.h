@@ -2,6 +2,7 @@
 #include <glm\detail\type_mat.hpp>
 #include <glm/glm.hpp>
 #include <vector>
+#include "BoundingVolume.h"
 
 #ifndef  CuboidMesh_h
 #define CuboidMesh_h
@@ -58,6 +59,7 @@ public:
 		-0.5f,-0.5f,0.5f, 0.0f,-1.0f,0.0f,  0.0f,-1.0f,// v0
 		-0.5f,-0.5f,-0.5f, 0.0f,-1.0f,0.0f,  0.0f,0.0f,// v5
 	};
+	BoundingVolume bounds; // of data
 	CuboidMesh(); // default constructor 
 	CuboidMesh(float length, float height, float width); // 
 };
@@ -1,27 +1,86 @@
 #include "Cylinder.h"
+#include "ParametricMeshGenerator.h"
+#include "VertexBufferWriter.h"
+#include <cmath>
 
+// shared unit cylinder geometry (radius and length 1) of a tessellation, "cpuCopy" is uploaded instead of generating a new mesh if given
+static Geometry* AcquireCylinderGeometry(int segments, bool indexed, bool packed, const CylinderMesh* cpuCopy) {
+	GeometryKey key(PRIMITIVE_CYLINDER, 1.0f, 1.0f, 0.0f, segments, 0, indexed, packed);
+	return AcquireGeometry(key, [&](Geometry& shared) { // only built for the first cylinder of this kind
+		if (!indexed && !packed && cpuCopy == nullptr) {
+			// plain float triangle list: generate it straight into the mapped VBO, no CPU side copy
+			size_t floatCount = CylinderMeshFloatCount(segments);
+			WriteVertexBuffer(floatCount, [&](float* out) {
+				GenerateCylinderMesh(1.0f, 1.0f, segments, out);
+			});
+			SetVertexLayout(false);
+			shared.bounds = CylinderMeshBounds(1.0f, 1.0f);
+			shared.elementCount = (GLsizei)(floatCount / 8);
+			return;
+		}
 
-Cylinder::Cylinder(glm::mat4 _transform, float radius, float length, int segments, float r, float g, float b, float ka, float kd, float ks, glm::vec3 position, int alpha) {
-	mesh = CylinderMesh(radius, length, segments);
+		CylinderMesh temporary;
+		const CylinderMesh* source = cpuCopy;
+		if (source == nullptr) {
+			temporary = CylinderMesh(1.0f, 1.0f, segments, indexed); // released again once uploaded
+			source = &temporary;
+		}
+		UploadMeshGeometry(shared, source->data, source->vertices, source->indices, source->indexed, source->shortIndices, packed);
+	});
+}
+
+Cylinder::Cylinder(glm::mat4 _transform, float _radius, float _length, int _segments, float r, float g, float b, float ka, float kd, float ks, glm::vec3 position, int alpha, bool indexed, bool packed, bool keepCpuCopy, int lodLevels, bool procedural) {
 	material = Material(r, g, b, ka, kd, ks, alpha);
 	texture = Texture("assets/textures/tiles_diffuse.dds");
+	material.textureLayer = texture.layer; // -1 unless the texture was packed into an array
 	position = position;
-	transform = glm::translate(_transform, position);
-
-	glGenVertexArrays(1, &Vao); // create the VAO
-	glBindVertexArray(Vao); // bind the VAO
+	radius = _radius;
+	length = _length;
+	transform = glm::scale(glm::translate(_transform, position), glm::vec3(radius, length, radius)); // the mesh is a unit cylinder
+	segments = _segments;
+	boundingRadius = std::sqrt(radius * radius + 0.25f * length * length); // the mesh is centered on the origin
 
-	glGenBuffers(1, &Vbo); // generate the VBO
-	glBindBuffer(GL_ARRAY_BUFFER, Vbo); // bind the VBO
-	glBufferData(GL_ARRAY_BUFFER, mesh.data.size() * sizeof(float), &mesh.data[0], GL_STATIC_DRAW);
+	if (keepCpuCopy) {
+		mesh = CylinderMesh(1.0f, 1.0f, segments, indexed); // kept for picking or physics, finest level only, unit size
+	}
 
-	glEnableVertexAttribArray(0); // set position attribute vertex layout  1/2
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), 0); // set vertex layout 2/2
+	// level 0 is the requested tessellation, every further level halves the segment count
+	int levelSegments = segments;
+	for (int level = 0; level < lodLevels; level++) {
+		if (level > 0 && levelSegments / 2 < 4) {
+			break; // any coarser and the caps turn into triangles
+		}
+		if (level > 0) {
+			levelSegments /= 2;
+		}
+		if (procedural) {
+			lod.AddLevel(nullptr, levelSegments); // built by ProceduralShader.vert at draw time, nothing to upload
+			continue;
+		}
+		lod.AddLevel(AcquireCylinderGeometry(levelSegments, indexed, packed, level == 0 && keepCpuCopy ? &mesh : nullptr), levelSegments);
+	}
+	geometry = lod.levels[0].geometry;
+	bounds = geometry != nullptr ? geometry->bounds : CylinderMeshBounds(1.0f, 1.0f); // procedural cylinders have no vertex data
+}
 
-	glEnableVertexAttribArray(1); // set color attribute vertex layout 1/2
-	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
+void Cylinder::UpdateLod(const glm::mat4& projection, glm::vec3 cameraPosition, int viewportHeight) {
+	glm::vec3 center = glm::vec3(transform[3]); // world space translation of the cylinder
+	geometry = lod.Select(ProjectedScreenRadius(projection, cameraPosition, center, boundingRadius, viewportHeight));
+}
 
-	glEnableVertexAttribArray(2); // set color attribute vertex layout 1/2
-	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
+DrawPacket Cylinder::MakeDrawPacket() const {
+	DrawPacket packet = DrawPacket();
+	packet.texture = texture.Handle();
+	packet.textureTarget = texture.target;
+	packet.geometry = geometry;
+	packet.primitive = PRIMITIVE_CYLINDER;
+	packet.segments[0] = segments >> lod.current; // every level halves the segment count
+	packet.segments[1] = 0;
+	packet.transform = &transform;
+	packet.material = &material;
+	return packet;
+}
 
+BoundingVolume Cylinder::WorldBounds() const {
+	return TransformBounds(bounds, transform);
 }
@@ -5,21 +5,32 @@
 #include "CylinderMesh.h"
 #include "Material.h"
 #include "Texture.h"
+#include "GeometryRegistry.h"
+#include "LevelOfDetail.h"
+#include "RenderQueue.h"
+#include "BoundingVolume.h"
 
 #ifndef  Cylinder_h
 #define Cylinder_h
 
 class Cylinder {
 public:
-	CylinderMesh mesh; // mesh of the cylinder
-	glm::mat4 transform; // transform of the cylinder
-	GLuint Vao; // vertex array object
-	GLuint Vbo; // vertex buffer object
-	GLuint Ebo; // element buffer object
+	CylinderMesh mesh; // CPU side mesh of the cylinder, empty unless keepCpuCopy was requested
+	glm::mat4 transform; // transform of the cylinder, scales the unit cylinder to its radius and length
+	Geometry* geometry; // unit cylinder VAO/VBO shared with every cylinder of the same tessellation, the active LOD level
+	LodChain lod; // tessellation levels, finest first
+	float boundingRadius; // radius of the bounding sphere used for LOD selection
+	BoundingVolume bounds; // object space bounds of the unit mesh
+	float radius; // radius of the cylinder
+	float length; // length of the cylinder
+	int segments; // segments of the finest level, halved per level
 	Material material;
 	glm::vec3 position;
 	Texture texture;
-	Cylinder::Cylinder(glm::mat4 transform, float radius, float length, int segments, float r, float g, float b, float ka, float kd, float ks, glm::vec3 position, int alpha); // cylinder constructor
+	Cylinder::Cylinder(glm::mat4 transform, float radius, float length, int segments, float r, float g, float b, float ka, float kd, float ks, glm::vec3 position, int alpha, bool indexed = false, bool packed = false, bool keepCpuCopy = false, int lodLevels = 1, bool procedural = false); // cylinder constructor
+	void UpdateLod(const glm::mat4& projection, glm::vec3 cameraPosition, int viewportHeight); // picks the level for the current view
+	DrawPacket MakeDrawPacket() const; // draw packet of the active LOD level
+	BoundingVolume WorldBounds() const; // bounds transformed by transform
 };
 
 #endif /Cylinder_h/
\ No newline at end of file
@@ -2,15 +2,22 @@
 #include <glm\detail\type_mat.hpp>
 #include <glm/glm.hpp>
 #include <vector>
+#include "BoundingVolume.h"
 
 #ifndef  CylinderMesh_h
 #define CylinderMesh_h
 
 class CylinderMesh {
 public:
-	std::vector<float> data; // dynamic vertices array
+	std::vector<float> data; // dynamic vertices array, 3 vertices per triangle (empty if indexed)
+	std::vector<float> vertices; // unique vertices array (indexed mode only)
+	std::vector<unsigned int> indices; // triangle indices into vertices (indexed mode only)
+	bool indexed; // true if the mesh is stored as vertices + indices instead of data
+	bool shortIndices; // true if the indices fit into a 16 bit index buffer
+	BoundingVolume bounds; // of the generated vertices, kept after ReleaseCpuData
+	void ReleaseCpuData(); // frees data, vertices and indices once they live on the GPU
 	CylinderMesh(); // default constructor
-	CylinderMesh(float radius, float length, int segments); // cylinder mesh  constructor
+	CylinderMesh(float radius, float length, int segments, bool indexed = false); // cylinder mesh  constructor
 };
 
 #endif /CylinderMesh_h/
\ No newline at end of file
@@ -0,0 +1,18 @@
+//fragment shader of the deferred composite, copies the accumulated lighting and the G-buffer depth into the default framebuffer
+#version 430
+
+out vec4 FragColor;
+
+uniform sampler2D lighting;
+uniform sampler2D gDepth;
+
+void main()
+{
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+    float depth = texelFetch(gDepth, pixel, 0).r;
+    if (depth == 1.0) {
+        discard; // keep the clear color
+    }
+    FragColor = vec4(texelFetch(lighting, pixel, 0).rgb, 1.0);
+    gl_FragDepth = depth; // the depth pyramid and later passes read the default depth buffer
+}
@@ -0,0 +1,24 @@
+//fragment shader of the deferred directional light, one fullscreen pass adding ambient, diffuse and specular of every G-buffer pixel
+#version 430
+
+#include "FrameData.glsl"
+#include "PhongLighting.glsl"
+#include "Octahedral.glsl"
+#include "GBufferSurface.glsl"
+
+out vec4 FragColor;
+
+void main()
+{
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+    float depth = texelFetch(gDepth, pixel, 0).r;
+    if (depth == 1.0) {
+        discard; // background
+    }
+    vec3 albedo = texelFetch(gAlbedo, pixel, 0).rgb;
+    vec3 norm = DecodeOctahedral(texelFetch(gNormal, pixel, 0).rg * 2.0 - 1.0);
+    vec4 material = texelFetch(gMaterial, pixel, 0);
+    vec3 viewDir = normalize(viewPos - SurfacePosition(pixel, depth));
+    vec3 result = PhongLight(norm, normalize(-dLightDirection), viewDir, dLightColor, material.x, material.y, material.z, 10.0);
+    FragColor = vec4(result * albedo, 1.0);
+}
@@ -0,0 +1,30 @@
+//fragment shader of the deferred point lights, adds one light to the G-buffer pixels inside its volume
+#version 430
+
+#include "FrameData.glsl"
+#include "PointLights.glsl"
+#include "Octahedral.glsl"
+#include "GBufferSurface.glsl"
+
+flat in int LightIndex;
+out vec4 FragColor;
+
+void main()
+{
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+    float depth = texelFetch(gDepth, pixel, 0).r;
+    vec3 position = SurfacePosition(pixel, depth);
+    vec3 toLight = lightPositionRange[LightIndex].xyz - position;
+    float distance = length(toLight);
+    float range = lightPositionRange[LightIndex].w;
+    if (distance >= range) {
+        discard; // the surface seen through the volume lies outside the sphere
+    }
+
+    vec3 albedo = texelFetch(gAlbedo, pixel, 0).rgb;
+    vec3 norm = DecodeOctahedral(texelFetch(gNormal, pixel, 0).rg * 2.0 - 1.0);
+    vec4 material = texelFetch(gMaterial, pixel, 0);
+    vec3 viewDir = normalize(viewPos - position);
+    vec3 result = PointLight(uint(LightIndex), position, norm, viewDir, material.x, material.y, material.z, round(material.w * 255.0));
+    FragColor = vec4(result * albedo, 1.0);
+}
@@ -0,0 +1,28 @@
+//vertex shader of the deferred point lights, one instance per light, a coarse sphere around the light scaled to its range
+#version 430
+
+#include "FrameData.glsl"
+#include "PointLights.glsl"
+
+flat out int LightIndex;
+
+const int kRings = 8; // tessellation of the light volume
+const int kSegments = 12;
+const float PI = 3.14159265;
+
+void main()
+{
+    const ivec2 corners[6] = ivec2[6](ivec2(0, 0), ivec2(1, 0), ivec2(1, 1), ivec2(0, 0), ivec2(1, 1), ivec2(0, 1)); // two triangles per quad, counter clockwise from outside
+    int quad = gl_VertexID / 6;
+    ivec2 cell = ivec2(quad % kSegments, quad / kSegments) + corners[gl_VertexID % 6];
+    float azimuth = float(cell.x) / float(kSegments) * 2.0 * PI;
+    float polar = float(cell.y) / float(kRings) * PI;
+    vec3 direction = vec3(sin(polar) * cos(azimuth), cos(polar), sin(polar) * sin(azimuth));
+
+    // the flat faces lie inside the sphere, pushing the vertices out by the inverse face distance makes the volume cover it
+    float cover = 1.0 / (cos(PI / float(kSegments)) * cos(PI / float(2 * kRings)));
+    vec4 light = lightPositionRange[gl_InstanceID];
+    float radius = min(light.w, 1.0e4) * cover; // lights without falloff get a finite volume, depth clamp keeps its back faces from the far plane
+    gl_Position = proj * (view * vec4(light.xyz + direction * radius, 1.0));
+    LightIndex = gl_InstanceID;
+}
@@ -0,0 +1,147 @@
+#include "DepthPyramid.h"
+#include <algorithm>
+#include <iostream>
+#include "ComputeProgram.h"
+#include "GLStateCache.h"
+
+const GLuint kReduceGroupSize = 8; // local_size_x/y of DepthPyramid.comp
+
+DepthPyramid::DepthPyramid(int _viewportWidth, int _viewportHeight) {
+	viewportWidth = _viewportWidth;
+	viewportHeight = _viewportHeight;
+	width = 1;
+	while (width * 2 <= viewportWidth) {
+		width *= 2;
+	}
+	height = 1;
+	while (height * 2 <= viewportHeight) {
+		height *= 2;
+	}
+	levels = 1;
+	while ((std::max(width, height) >> levels) > 0) {
+		levels++;
+	}
+
+	// a depth blit needs matching formats, so the copy takes the format of the default framebuffer's depth buffer
+	GLint depthBits = 24;
+	GLint stencilBits = 0;
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glGetFramebufferAttachmentParameteriv(GL_FRAMEBUFFER, GL_DEPTH, GL_FRAMEBUFFER_ATTACHMENT_DEPTH_SIZE, &depthBits);
+	glGetFramebufferAttachmentParameteriv(GL_FRAMEBUFFER, GL_STENCIL, GL_FRAMEBUFFER_ATTACHMENT_STENCIL_SIZE, &stencilBits);
+	GLenum depthFormat = GL_DEPTH_COMPONENT24;
+	if (stencilBits > 0) {
+		depthFormat = depthBits > 24 ? GL_DEPTH32F_STENCIL8 : GL_DEPTH24_STENCIL8;
+	}
+	else if (depthBits > 24) {
+		depthFormat = GL_DEPTH_COMPONENT32F;
+	}
+	else if (depthBits <= 16) {
+		depthFormat = GL_DEPTH_COMPONENT16;
+	}
+
+	glGenTextures(1, &depthTexture);
+	CachedBindTexture(kDepthPyramidUnit, GL_TEXTURE_2D, depthTexture);
+	glTexStorage2D(GL_TEXTURE_2D, 1, depthFormat, viewportWidth, viewportHeight);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_MODE, GL_NONE); // read the depth values, not comparisons
+
+	// the window is multisampled and glCopyTexSubImage2D cannot read from it, a blit into this framebuffer resolves the depth
+	glGenFramebuffers(1, &resolveFramebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, resolveFramebuffer);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, stencilBits > 0 ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depthTexture, 0);
+	glDrawBuffer(GL_NONE); // depth only
+	glReadBuffer(GL_NONE);
+	resolveComplete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+	if (!resolveComplete) {
+		std::cerr << "ERROR: depth pyramid resolve framebuffer incomplete, occlusion culling stays off";
+	}
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	if (resolveComplete) { // one trial blit, formats and sample counts do not change afterwards so Build never checks again
+		for (GLenum error = glGetError(); error != GL_NO_ERROR; error = glGetError()) {
+			std::cerr << "ERROR: GL error " << error << " before the depth pyramid was created\n";
+		}
+		Resolve();
+		resolveComplete = glGetError() == GL_NO_ERROR;
+		if (!resolveComplete) {
+			std::cerr << "ERROR: depth pyramid resolve blit rejected, occlusion culling stays off";
+		}
+	}
+
+	glGenTextures(1, &pyramid);
+	CachedBindTexture(kDepthPyramidUnit, GL_TEXTURE_2D, pyramid);
+	glTexStorage2D(GL_TEXTURE_2D, levels, GL_R32F, width, height);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST); // never blend depths
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+	reduceProgram = LoadComputeProgram("assets/DepthPyramid.comp");
+	fromDepthBufferLocation = glGetUniformLocation(reduceProgram, "fromDepthBuffer");
+	sourceSizeLocation = glGetUniformLocation(reduceProgram, "sourceSize");
+	targetSizeLocation = glGetUniformLocation(reduceProgram, "targetSize");
+	glGenVertexArrays(1, &debugVao);
+
+	viewProjection = glm::mat4(1.0f);
+	valid = false;
+}
+
+void DepthPyramid::Build(const glm::mat4& _viewProjection) {
+	if (!resolveComplete) {
+		return; // depthTexture would hold no depth, the pyramid stays invalid
+	}
+	Resolve();
+
+	CachedBindTexture(kDepthPyramidUnit, GL_TEXTURE_2D, depthTexture);
+
+	CachedUseProgram(reduceProgram);
+	int sourceWidth = viewportWidth;
+	int sourceHeight = viewportHeight;
+	for (int level = 0; level < levels; level++) {
+		int targetWidth = std::max(width >> level, 1);
+		int targetHeight = std::max(height >> level, 1);
+		glUniform1i(fromDepthBufferLocation, level == 0 ? 1 : 0);
+		glUniform2i(sourceSizeLocation, sourceWidth, sourceHeight);
+		glUniform2i(targetSizeLocation, targetWidth, targetHeight);
+		glBindImageTexture(0, pyramid, std::max(level - 1, 0), GL_FALSE, 0, GL_READ_ONLY, GL_R32F); // unused for level 0
+		glBindImageTexture(1, pyramid, level, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+		glDispatchCompute((targetWidth + kReduceGroupSize - 1) / kReduceGroupSize, (targetHeight + kReduceGroupSize - 1) / kReduceGroupSize, 1);
+		glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT); // the next level reads this one
+		sourceWidth = targetWidth;
+		sourceHeight = targetHeight;
+	}
+	glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT); // the cull pass samples the pyramid
+
+	viewProjection = _viewProjection;
+	valid = true;
+}
+
+void DepthPyramid::Resolve() {
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, resolveFramebuffer);
+	glBlitFramebuffer(0, 0, viewportWidth, viewportHeight, 0, 0, viewportWidth, viewportHeight, GL_DEPTH_BUFFER_BIT, GL_NEAREST); // resolves the samples, stays on the GPU
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void DepthPyramid::Bind() {
+	CachedBindTexture(kDepthPyramidUnit, GL_TEXTURE_2D, pyramid);
+}
+
+void DepthPyramid::DrawDebug(GLuint program, int level) {
+	CachedUseProgram(program);
+	glUniform1i(glGetUniformLocation(program, "depthPyramid"), kDepthPyramidUnit);
+	glUniform1f(glGetUniformLocation(program, "level"), (float)level);
+	Bind();
+	CachedSetCapability(GL_DEPTH_TEST, false); // over the whole frame
+	CachedBindVertexArray(debugVao);
+	glDrawArrays(GL_TRIANGLES, 0, 3);
+	CachedSetCapability(GL_DEPTH_TEST, true);
+}
+
+void DepthPyramid::Release() {
+	glDeleteProgram(reduceProgram);
+	glDeleteFramebuffers(1, &resolveFramebuffer);
+	CachedDeleteTexture(depthTexture);
+	CachedDeleteTexture(pyramid);
+	CachedDeleteVertexArray(debugVao);
+}
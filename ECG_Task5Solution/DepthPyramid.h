@@ -0,0 +1,40 @@
+#pragma once
+#include <GL\glew.h>
+#include <glm/glm.hpp>
+
+#ifndef  DepthPyramid_h
+#define DepthPyramid_h
+
+const GLuint kDepthPyramidUnit = 2; // texture unit the pyramid is sampled from, units 0 and 1 hold the material textures
+
+// hierarchical Z buffer of the last frame. Level 0 is the largest power of two that fits the viewport,
+// every texel holds the farthest depth of the screen area it covers, so a rectangle that is nearer than
+// the 4 texels of the level where it spans at most 2x2 texels is certainly hidden
+class DepthPyramid {
+public:
+	GLuint depthTexture; // single sample copy of the depth buffer of the default framebuffer, same format so it can be blitted
+	GLuint resolveFramebuffer; // depthTexture as depth attachment, the target of the resolving blit
+	GLuint pyramid; // R32F mip chain
+	int width; // of level 0
+	int height;
+	int levels;
+	glm::mat4 viewProjection; // of the frame the pyramid was built from, objects are tested in that frame
+	bool valid; // false until the first Build that resolved the depth buffer
+	DepthPyramid(int viewportWidth, int viewportHeight); // needs a current GL context
+	void Build(const glm::mat4& viewProjection); // copies the depth buffer and reduces it, call after the last draw and before swapping
+	void Bind(); // binds the pyramid to kDepthPyramidUnit
+	void DrawDebug(GLuint program, int level); // draws "level" over the viewport with PyramidDebug.vert/.frag
+	void Release();
+private:
+	int viewportWidth;
+	int viewportHeight;
+	bool resolveComplete; // resolveFramebuffer is complete and took the trial blit of the constructor, Build does nothing otherwise
+	GLuint reduceProgram;
+	GLint fromDepthBufferLocation;
+	GLint sourceSizeLocation;
+	GLint targetSizeLocation;
+	GLuint debugVao; // empty, the debug triangle comes from gl_VertexID
+	void Resolve(); // blits the depth of the default framebuffer into depthTexture
+};
+
+#endif /DepthPyramid_h/
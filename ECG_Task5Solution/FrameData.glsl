@@ -0,0 +1,17 @@
+//chunk: per frame camera and light data, see FrameData in FrameUniformBuffer.h
+#ifndef FRAME_DATA_GLSL
+#define FRAME_DATA_GLSL
+
+// per frame camera and light data, written once per frame by the application (std140, binding 0)
+layout (std140, binding = 0) uniform FrameData {
+    mat4 view;
+    mat4 proj;
+    vec3 viewPos;
+    uint pointLightCount; // lights in the LightPositions/LightColors/LightAttenuations buffers
+    uvec4 clusterGrid; // froxels along x, y and z, w = maximum lights per froxel
+    vec4 clusterScale; // froxels per pixel in x and y, slice = log(view depth) * z + w
+    vec3 dLightColor;
+    vec3 dLightDirection;
+};
+
+#endif
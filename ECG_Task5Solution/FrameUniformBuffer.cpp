@@ -0,0 +1,47 @@
+#include "FrameUniformBuffer.h"
+#include <cstring>
+
+static_assert(sizeof(FrameData) == 208, "FrameData has to match the std140 layout of the shader block");
+
+FrameUniformBuffer::FrameUniformBuffer(StreamRingBuffer* _stream) {
+	stream = _stream;
+	glGenBuffers(1, &Ubo); // generate the UBO
+	glBindBuffer(GL_UNIFORM_BUFFER, Ubo);
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameData), nullptr, GL_DYNAMIC_DRAW); // rewritten every frame
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	glBindBufferBase(GL_UNIFORM_BUFFER, kFrameDataBinding, Ubo); // every program reads FrameData from this binding
+}
+
+void FrameUniformBuffer::Update(const glm::mat4& viewMatrix, const OrbitalCamera& camera, const ClusteredLights& pointLights, const DirectionalLightSource& dLightSource) {
+	FrameData data;
+	data.view = viewMatrix;
+	data.proj = camera.projectionMatrix;
+	data.viewPos = camera.cameraPosition;
+	data.pointLightCount = pointLights.Count();
+	data.clusterGrid = pointLights.grid;
+	data.clusterScale = pointLights.scale;
+	data.dLightColor = dLightSource.color;
+	data.padding0 = 0.0f;
+	data.dLightDirection = dLightSource.direction;
+	data.padding1 = 0.0f;
+
+	if (stream != nullptr) {
+		StreamAllocation allocation = stream->AllocateUniforms(sizeof(FrameData));
+		if (allocation.data != nullptr) { // written straight into mapped memory, the fence of the segment protects frames in flight
+			memcpy(allocation.data, &data, sizeof(FrameData));
+			glBindBufferRange(GL_UNIFORM_BUFFER, kFrameDataBinding, stream->Buffer, allocation.offset, sizeof(FrameData));
+			return;
+		}
+	}
+
+	glBindBuffer(GL_UNIFORM_BUFFER, Ubo);
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameData), nullptr, GL_DYNAMIC_DRAW); // orphan, the previous frame may still read the old storage
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameData), &data);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	glBindBufferBase(GL_UNIFORM_BUFFER, kFrameDataBinding, Ubo); // a previous frame may have bound a stream range
+}
+
+void FrameUniformBuffer::Release() {
+	glDeleteBuffers(1, &Ubo);
+	Ubo = 0;
+}
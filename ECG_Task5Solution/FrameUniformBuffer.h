@@ -0,0 +1,38 @@
+#pragma once
+#include <GL\glew.h>
+#include <glm/glm.hpp>
+#include "OrbitalCamera.h"
+#include "ClusteredLighting.h"
+#include "DirectionalLightSource.h"
+#include "StreamRingBuffer.h"
+
+#ifndef  FrameUniformBuffer_h
+#define FrameUniformBuffer_h
+
+const GLuint kFrameDataBinding = 0; // uniform block binding of FrameData in the shaders
+
+// CPU side mirror of the std140 FrameData block, every vec3 is followed by a float or padding to fill its 16 byte slot
+struct FrameData {
+	glm::mat4 view;
+	glm::mat4 proj;
+	glm::vec3 viewPos;
+	GLuint pointLightCount;
+	glm::uvec4 clusterGrid; // froxels along x, y and z, w = maximum lights per froxel
+	glm::vec4 clusterScale; // froxels per pixel in x and y, slice = log(view depth) * z + w
+	glm::vec3 dLightColor;
+	float padding0;
+	glm::vec3 dLightDirection;
+	float padding1;
+};
+
+// uniform buffer holding the camera and light data shared by every program and draw of a frame
+class FrameUniformBuffer {
+public:
+	GLuint Ubo; // uniform buffer object, bound to kFrameDataBinding unless the data comes from "stream"
+	StreamRingBuffer* stream; // per frame ring the data is written to, Ubo is the fallback if it is nullptr or full
+	FrameUniformBuffer(StreamRingBuffer* stream = nullptr); // creates and binds the buffer, needs a current GL context
+	void Update(const glm::mat4& viewMatrix, const OrbitalCamera& camera, const ClusteredLights& pointLights, const DirectionalLightSource& dLightSource); // writes this frame's data, after pointLights.Bin
+	void Release(); // deletes the buffer
+};
+
+#endif /FrameUniformBuffer_h/
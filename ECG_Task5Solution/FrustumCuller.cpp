@@ -0,0 +1,138 @@
+#include "FrustumCuller.h"
+#include <cmath>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define FRUSTUM_CULLER_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define FRUSTUM_CULLER_SSE2
+#endif
+
+void ExtractFrustumPlanes(const glm::mat4& m, glm::vec4 planes[6]) {
+	glm::vec4 row0 = glm::vec4(m[0][0], m[1][0], m[2][0], m[3][0]); // glm is column major
+	glm::vec4 row1 = glm::vec4(m[0][1], m[1][1], m[2][1], m[3][1]);
+	glm::vec4 row2 = glm::vec4(m[0][2], m[1][2], m[2][2], m[3][2]);
+	glm::vec4 row3 = glm::vec4(m[0][3], m[1][3], m[2][3], m[3][3]);
+	planes[0] = row3 + row0; // left
+	planes[1] = row3 - row0; // right
+	planes[2] = row3 + row1; // bottom
+	planes[3] = row3 - row1; // top
+	planes[4] = row3 + row2; // near, OpenGL clip space has z in [-w, w]
+	planes[5] = row3 - row2; // far
+	for (int i = 0; i < 6; i++) {
+		planes[i] /= glm::length(glm::vec3(planes[i]));
+	}
+}
+
+FrustumCuller::FrustumCuller() {
+	tested = 0;
+	culled = 0;
+}
+
+void FrustumCuller::Clear() {
+	centerX.clear(); centerY.clear(); centerZ.clear(); radius.clear();
+	minX.clear(); minY.clear(); minZ.clear();
+	maxX.clear(); maxY.clear(); maxZ.clear();
+	visible.clear();
+}
+
+unsigned int FrustumCuller::Add(const BoundingVolume& bounds) {
+	centerX.push_back(bounds.center.x);
+	centerY.push_back(bounds.center.y);
+	centerZ.push_back(bounds.center.z);
+	radius.push_back(bounds.radius);
+	minX.push_back(bounds.min.x);
+	minY.push_back(bounds.min.y);
+	minZ.push_back(bounds.min.z);
+	maxX.push_back(bounds.max.x);
+	maxY.push_back(bounds.max.y);
+	maxZ.push_back(bounds.max.z);
+	return (unsigned int)(centerX.size() - 1);
+}
+
+void FrustumCuller::Cull(const glm::mat4& viewProjection) {
+	glm::vec4 planes[6];
+	ExtractFrustumPlanes(viewProjection, planes);
+
+	// per plane the box corner farthest along the normal, the sign is the same for every object
+	const float* cornerX[6];
+	const float* cornerY[6];
+	const float* cornerZ[6];
+	size_t count = centerX.size();
+	visible.resize(count);
+	for (int p = 0; p < 6; p++) {
+		cornerX[p] = planes[p].x >= 0.0f ? maxX.data() : minX.data();
+		cornerY[p] = planes[p].y >= 0.0f ? maxY.data() : minY.data();
+		cornerZ[p] = planes[p].z >= 0.0f ? maxZ.data() : minZ.data();
+	}
+
+	size_t i = 0;
+#if defined(FRUSTUM_CULLER_AVX2)
+	for (; i + 8 <= count; i += 8) {
+		__m256 x = _mm256_loadu_ps(&centerX[i]);
+		__m256 y = _mm256_loadu_ps(&centerY[i]);
+		__m256 z = _mm256_loadu_ps(&centerZ[i]);
+		__m256 negativeRadius = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(&radius[i]));
+		__m256 outside = _mm256_setzero_ps();
+		for (int p = 0; p < 6; p++) {
+			__m256 nx = _mm256_set1_ps(planes[p].x);
+			__m256 ny = _mm256_set1_ps(planes[p].y);
+			__m256 nz = _mm256_set1_ps(planes[p].z);
+			__m256 d = _mm256_set1_ps(planes[p].w);
+			__m256 sphereDistance = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(nx, x), _mm256_mul_ps(ny, y)), _mm256_add_ps(_mm256_mul_ps(nz, z), d));
+			__m256 cornerDistance = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(nx, _mm256_loadu_ps(cornerX[p] + i)), _mm256_mul_ps(ny, _mm256_loadu_ps(cornerY[p] + i))),
+				_mm256_add_ps(_mm256_mul_ps(nz, _mm256_loadu_ps(cornerZ[p] + i)), d)); // no FMA, /arch:AVX2 does not imply it everywhere
+			outside = _mm256_or_ps(outside, _mm256_cmp_ps(sphereDistance, negativeRadius, _CMP_LT_OQ));
+			outside = _mm256_or_ps(outside, _mm256_cmp_ps(cornerDistance, _mm256_setzero_ps(), _CMP_LT_OQ));
+		}
+		int mask = _mm256_movemask_ps(outside);
+		for (int k = 0; k < 8; k++) {
+			visible[i + k] = (mask >> k) & 1 ? 0 : 1;
+		}
+	}
+#elif defined(FRUSTUM_CULLER_SSE2)
+	for (; i + 4 <= count; i += 4) {
+		__m128 x = _mm_loadu_ps(&centerX[i]);
+		__m128 y = _mm_loadu_ps(&centerY[i]);
+		__m128 z = _mm_loadu_ps(&centerZ[i]);
+		__m128 negativeRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(&radius[i]));
+		__m128 outside = _mm_setzero_ps();
+		for (int p = 0; p < 6; p++) {
+			__m128 nx = _mm_set1_ps(planes[p].x);
+			__m128 ny = _mm_set1_ps(planes[p].y);
+			__m128 nz = _mm_set1_ps(planes[p].z);
+			__m128 d = _mm_set1_ps(planes[p].w);
+			__m128 sphereDistance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, x), _mm_mul_ps(ny, y)), _mm_add_ps(_mm_mul_ps(nz, z), d));
+			__m128 cornerDistance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, _mm_loadu_ps(cornerX[p] + i)), _mm_mul_ps(ny, _mm_loadu_ps(cornerY[p] + i))),
+				_mm_add_ps(_mm_mul_ps(nz, _mm_loadu_ps(cornerZ[p] + i)), d));
+			outside = _mm_or_ps(outside, _mm_cmplt_ps(sphereDistance, negativeRadius));
+			outside = _mm_or_ps(outside, _mm_cmplt_ps(cornerDistance, _mm_setzero_ps()));
+		}
+		int mask = _mm_movemask_ps(outside);
+		for (int k = 0; k < 4; k++) {
+			visible[i + k] = (mask >> k) & 1 ? 0 : 1;
+		}
+	}
+#endif
+	for (; i < count; i++) { // scalar tail and fallback
+		bool outside = false;
+		for (int p = 0; p < 6 && !outside; p++) {
+			glm::vec4 plane = planes[p];
+			float sphereDistance = plane.x * centerX[i] + plane.y * centerY[i] + plane.z * centerZ[i] + plane.w;
+			float cornerDistance = plane.x * cornerX[p][i] + plane.y * cornerY[p][i] + plane.z * cornerZ[p][i] + plane.w;
+			outside = sphereDistance < -radius[i] || cornerDistance < 0.0f;
+		}
+		visible[i] = outside ? 0 : 1;
+	}
+
+	tested = (unsigned int)count;
+	culled = 0;
+	for (size_t k = 0; k < count; k++) {
+		culled += visible[k] ? 0 : 1;
+	}
+}
+
+bool FrustumCuller::Visible(unsigned int index) const {
+	return index < visible.size() && visible[index] != 0;
+}
@@ -0,0 +1,139 @@
+#include "GBuffer.h"
+#include <iostream>
+#include <glm/gtc/type_ptr.hpp>
+#include "GLStateCache.h"
+
+const GLsizei kLightVolumeVertices = 8 * 12 * 6; // kRings * kSegments quads of DeferredPointLight.vert
+
+static GLuint CreateTarget(GLenum format, int width, int height, GLenum attachment) {
+	GLuint texture;
+	glGenTextures(1, &texture);
+	CachedBindTexture(kGBufferFirstUnit, GL_TEXTURE_2D, texture);
+	glTexStorage2D(GL_TEXTURE_2D, 1, format, width, height);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST); // read with texelFetch
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, attachment, GL_TEXTURE_2D, texture, 0);
+	return texture;
+}
+
+GBufferFormat ParseGBufferFormat(const std::string& normals, const std::string& depth) {
+	GBufferFormat format;
+	format.normal = GL_RG16;
+	if (normals == "rg8") {
+		format.normal = GL_RG8; // 2 bytes, visible banding in the specular highlights
+	}
+	else if (normals == "rg16f") {
+		format.normal = GL_RG16F;
+	}
+	format.depth = depth == "d24" ? GL_DEPTH_COMPONENT24 : GL_DEPTH_COMPONENT32F;
+	return format;
+}
+
+GBuffer::GBuffer(int _width, int _height, GBufferFormat _format) {
+	width = _width;
+	height = _height;
+	format = _format;
+	glGenFramebuffers(1, &framebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+	albedo = CreateTarget(GL_RGBA8, width, height, GL_COLOR_ATTACHMENT0);
+	normal = CreateTarget(format.normal, width, height, GL_COLOR_ATTACHMENT1);
+	material = CreateTarget(GL_RGBA8, width, height, GL_COLOR_ATTACHMENT2);
+	depth = CreateTarget(format.depth, width, height, GL_DEPTH_ATTACHMENT);
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+		std::cerr << "ERROR: G-buffer framebuffer incomplete";
+	}
+	glGenFramebuffers(1, &lightFramebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, lightFramebuffer);
+	lighting = CreateTarget(GL_RGBA16F, width, height, GL_COLOR_ATTACHMENT0);
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+		std::cerr << "ERROR: lighting framebuffer incomplete";
+	}
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glGenVertexArrays(1, &emptyVao);
+}
+
+void GBuffer::BeginGeometry() {
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+	const GLenum surfaceTargets[3] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2 };
+	glDrawBuffers(3, surfaceTargets);
+	CachedColorMask(true);
+	CachedDepthMask(true); // glClear only touches writable buffers
+	const GLfloat zero[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	for (GLint i = 0; i < 3; i++) {
+		glClearBufferfv(GL_COLOR, i, zero);
+	}
+	const GLfloat farDepth = 1.0f;
+	glClearBufferfv(GL_DEPTH, 0, &farDepth);
+}
+
+void GBuffer::BindTextures(GLuint program) {
+	CachedBindTexture(kGBufferFirstUnit, GL_TEXTURE_2D, albedo);
+	CachedBindTexture(kGBufferFirstUnit + 1, GL_TEXTURE_2D, normal);
+	CachedBindTexture(kGBufferFirstUnit + 2, GL_TEXTURE_2D, material);
+	CachedBindTexture(kGBufferFirstUnit + 3, GL_TEXTURE_2D, depth);
+	glUniform1i(glGetUniformLocation(program, "gAlbedo"), kGBufferFirstUnit);
+	glUniform1i(glGetUniformLocation(program, "gNormal"), kGBufferFirstUnit + 1);
+	glUniform1i(glGetUniformLocation(program, "gMaterial"), kGBufferFirstUnit + 2);
+	glUniform1i(glGetUniformLocation(program, "gDepth"), kGBufferFirstUnit + 3);
+}
+
+void GBuffer::Light(GLuint directionalProgram, GLuint pointProgram, unsigned int pointLightCount, const glm::mat4& viewProjection) {
+	glm::mat4 inverseViewProjection = glm::inverse(viewProjection);
+	glBindFramebuffer(GL_FRAMEBUFFER, lightFramebuffer); // no depth attachment, sampling an attached texture would be a feedback loop
+	const GLfloat zero[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	glClearBufferfv(GL_COLOR, 0, zero);
+
+	CachedPolygonMode(GL_FILL); // also in wireframe mode, the G-buffer holds the wires
+	CachedSetCapability(GL_BLEND, true);
+	CachedBlendFunc(GL_ONE, GL_ONE); // every light adds to the target
+	CachedBindVertexArray(emptyVao);
+
+	CachedSetCapability(GL_DEPTH_TEST, false);
+	CachedSetCapability(GL_CULL_FACE, false);
+	CachedUseProgram(directionalProgram);
+	BindTextures(directionalProgram);
+	glUniformMatrix4fv(glGetUniformLocation(directionalProgram, "inverseViewProjection"), 1, GL_FALSE, glm::value_ptr(inverseViewProjection));
+	glDrawArrays(GL_TRIANGLES, 0, 3);
+
+	if (pointLightCount > 0) {
+		// back faces only, so every covered pixel is shaded once, also with the camera inside the volume.
+		// Surfaces in front of or behind the sphere are rejected in the shader by their distance to the light
+		CachedSetCapability(GL_CULL_FACE, true);
+		CachedCullFace(GL_FRONT);
+		CachedSetCapability(GL_DEPTH_CLAMP, true); // volumes reaching past the far plane keep their back faces
+		CachedUseProgram(pointProgram);
+		BindTextures(pointProgram);
+		glUniformMatrix4fv(glGetUniformLocation(pointProgram, "inverseViewProjection"), 1, GL_FALSE, glm::value_ptr(inverseViewProjection));
+		glDrawArraysInstanced(GL_TRIANGLES, 0, kLightVolumeVertices, (GLsizei)pointLightCount);
+		CachedSetCapability(GL_DEPTH_CLAMP, false);
+		CachedCullFace(GL_BACK);
+	}
+
+	CachedSetCapability(GL_BLEND, false);
+	CachedSetCapability(GL_DEPTH_TEST, true);
+}
+
+void GBuffer::Composite(GLuint program) {
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	CachedSetCapability(GL_CULL_FACE, false);
+	CachedDepthFunc(GL_ALWAYS); // gl_FragDepth replaces the cleared depth
+	CachedUseProgram(program);
+	CachedBindTexture(kGBufferFirstUnit, GL_TEXTURE_2D, lighting);
+	CachedBindTexture(kGBufferFirstUnit + 3, GL_TEXTURE_2D, depth);
+	glUniform1i(glGetUniformLocation(program, "lighting"), kGBufferFirstUnit);
+	glUniform1i(glGetUniformLocation(program, "gDepth"), kGBufferFirstUnit + 3);
+	CachedBindVertexArray(emptyVao);
+	glDrawArrays(GL_TRIANGLES, 0, 3);
+	CachedDepthFunc(GL_LESS);
+}
+
+void GBuffer::Release() {
+	glDeleteFramebuffers(1, &framebuffer);
+	glDeleteFramebuffers(1, &lightFramebuffer);
+	CachedDeleteTexture(albedo);
+	CachedDeleteTexture(normal);
+	CachedDeleteTexture(material);
+	CachedDeleteTexture(lighting);
+	CachedDeleteTexture(depth);
+	CachedDeleteVertexArray(emptyVao);
+}
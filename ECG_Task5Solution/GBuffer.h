@@ -0,0 +1,47 @@
+#pragma once
+#include <GL\glew.h>
+#include <glm/glm.hpp>
+#include <string>
+
+#ifndef  GBuffer_h
+#define GBuffer_h
+
+const GLuint kGBufferFirstUnit = 3; // albedo, normal, material and depth on units 3 to 6, after the material textures and the depth pyramid
+
+// selectable targets of the G-buffer, albedo and material are always RGBA8
+struct GBufferFormat {
+	GLenum normal; // octahedral normal mapped to [0, 1]: GL_RG8, GL_RG16 or GL_RG16F
+	GLenum depth; // GL_DEPTH_COMPONENT32F or GL_DEPTH_COMPONENT24
+};
+
+// format of the [render] gbuffer_normals (rg8, rg16, rg16f) and gbuffer_depth (d32f, d24) settings, unknown names keep rg16 and d32f
+GBufferFormat ParseGBufferFormat(const std::string& normals, const std::string& depth);
+
+// render targets of the deferred path, 10 to 12 bytes of surface data per pixel plus depth:
+// albedo RGBA8, octahedral normal (RG16 by default), material RGBA8 (k_ambient, k_diffuse, k_specular, alpha / 255)
+// and an RGBA16F target the lights are added into. Single sampled, the deferred path gives up MSAA
+class GBuffer {
+public:
+	GLuint framebuffer; // albedo, normal and material plus depth
+	GLuint lightFramebuffer; // lighting only, the light shaders sample every other target
+	GLuint albedo;
+	GLuint normal;
+	GLuint material;
+	GLuint lighting;
+	GLuint depth; // GBufferFormat::depth
+	int width;
+	int height;
+	GBufferFormat format;
+	GBuffer(int width, int height, GBufferFormat format); // needs a current GL context
+	void BeginGeometry(); // binds and clears the framebuffer, the opaque passes draw into albedo, normal and material
+	// adds the directional light in one fullscreen pass (DeferredFullscreen.vert + DeferredDirectional.frag) and
+	// every point light over the pixels of its volume (DeferredPointLight.vert/.frag), lights come from the ClusteredLights buffers
+	void Light(GLuint directionalProgram, GLuint pointProgram, unsigned int pointLightCount, const glm::mat4& viewProjection);
+	void Composite(GLuint program); // lighting and depth into the default framebuffer (DeferredFullscreen.vert + DeferredComposite.frag)
+	void Release();
+private:
+	GLuint emptyVao; // the passes build their vertices from gl_VertexID
+	void BindTextures(GLuint program);
+};
+
+#endif /GBuffer_h/
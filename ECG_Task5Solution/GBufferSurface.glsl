@@ -0,0 +1,19 @@
+//chunk: reading the G-buffer in the deferred light passes, see GBuffer.h
+#ifndef GBUFFER_SURFACE_GLSL
+#define GBUFFER_SURFACE_GLSL
+
+uniform sampler2D gAlbedo; // G-buffer, read with texelFetch at the pixel of the fragment
+uniform sampler2D gNormal;
+uniform sampler2D gMaterial;
+uniform sampler2D gDepth;
+uniform mat4 inverseViewProjection; // back from window depth to world space
+
+// world position of the surface at "pixel" from the G-buffer depth
+vec3 SurfacePosition(ivec2 pixel, float depth)
+{
+    vec4 ndc = vec4((vec2(pixel) + 0.5) / vec2(textureSize(gDepth, 0)), depth, 1.0) * 2.0 - 1.0;
+    vec4 world = inverseViewProjection * ndc;
+    return world.xyz / world.w;
+}
+
+#endif
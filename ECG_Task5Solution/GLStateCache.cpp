@@ -0,0 +1,221 @@
+#include "GLStateCache.h"
+
+static const GLuint kUnknown = 0xFFFFFFFF; // shadow value that never matches, the next call is issued
+static const int kTextureTargets = 3; // GL_TEXTURE_2D, GL_TEXTURE_2D_ARRAY, GL_TEXTURE_CUBE_MAP
+
+// shadow copy of the GL state
+struct ShadowState {
+	GLuint program;
+	GLuint vao;
+	GLuint activeUnit;
+	GLuint textures[kMaxCachedTextureUnits][kTextureTargets];
+	GLuint samplers[kMaxCachedTextureUnits];
+	GLuint cullFace; // capability flags, 0/1 or kUnknown
+	GLuint depthTest;
+	GLuint blend;
+	GLenum polygonMode;
+	GLenum frontFace;
+	GLenum cullFaceMode;
+	GLenum depthFunc;
+	GLuint depthMask;
+	GLuint colorMask; // all four channels together
+	GLenum blendSource;
+	GLenum blendDestination;
+};
+
+// state before the first call of each kind
+static ShadowState UnknownState() {
+	ShadowState state;
+	state.program = kUnknown;
+	state.vao = kUnknown;
+	state.activeUnit = kUnknown;
+	for (GLuint unit = 0; unit < kMaxCachedTextureUnits; unit++) {
+		for (int target = 0; target < kTextureTargets; target++) {
+			state.textures[unit][target] = kUnknown;
+		}
+		state.samplers[unit] = kUnknown;
+	}
+	state.cullFace = kUnknown;
+	state.depthTest = kUnknown;
+	state.blend = kUnknown;
+	state.polygonMode = kUnknown;
+	state.frontFace = kUnknown;
+	state.cullFaceMode = kUnknown;
+	state.depthFunc = kUnknown;
+	state.depthMask = kUnknown;
+	state.colorMask = kUnknown;
+	state.blendSource = kUnknown;
+	state.blendDestination = kUnknown;
+	return state;
+}
+
+static ShadowState shadow = UnknownState();
+static StateCacheCounters counters = { 0, 0 };
+
+// true if "value" already holds "wanted", otherwise stores it. Counts the call either way
+static bool Unchanged(GLuint& value, GLuint wanted) {
+	if (value == wanted) {
+		counters.skipped++;
+		return true;
+	}
+	value = wanted;
+	counters.issued++;
+	return false;
+}
+
+static int TextureTargetSlot(GLenum target) {
+	switch (target) {
+	case GL_TEXTURE_2D_ARRAY: return 1;
+	case GL_TEXTURE_CUBE_MAP: return 2;
+	default: return 0;
+	}
+}
+
+static GLuint* CapabilitySlot(GLenum capability) {
+	switch (capability) {
+	case GL_CULL_FACE: return &shadow.cullFace;
+	case GL_DEPTH_TEST: return &shadow.depthTest;
+	case GL_BLEND: return &shadow.blend;
+	default: return nullptr;
+	}
+}
+
+void CachedUseProgram(GLuint program) {
+	if (!Unchanged(shadow.program, program)) {
+		glUseProgram(program);
+	}
+}
+
+void CachedBindVertexArray(GLuint vao) {
+	if (!Unchanged(shadow.vao, vao)) {
+		glBindVertexArray(vao);
+	}
+}
+
+void CachedActiveTexture(GLuint unit) {
+	if (!Unchanged(shadow.activeUnit, unit)) {
+		glActiveTexture(GL_TEXTURE0 + unit);
+	}
+}
+
+void CachedBindTexture(GLuint unit, GLenum target, GLuint texture) {
+	if (unit >= kMaxCachedTextureUnits) { // not shadowed
+		CachedActiveTexture(unit);
+		glBindTexture(target, texture);
+		counters.issued++;
+		return;
+	}
+	GLuint& binding = shadow.textures[unit][TextureTargetSlot(target)];
+	if (binding == texture) {
+		counters.skipped++;
+		return;
+	}
+	CachedActiveTexture(unit); // only switched when a bind is really needed
+	Unchanged(binding, texture);
+	glBindTexture(target, texture);
+}
+
+void CachedBindSampler(GLuint unit, GLuint sampler) {
+	if (unit >= kMaxCachedTextureUnits) {
+		glBindSampler(unit, sampler);
+		counters.issued++;
+		return;
+	}
+	if (!Unchanged(shadow.samplers[unit], sampler)) {
+		glBindSampler(unit, sampler);
+	}
+}
+
+void CachedSetCapability(GLenum capability, bool enabled) {
+	GLuint* slot = CapabilitySlot(capability);
+	if (slot != nullptr && Unchanged(*slot, enabled ? 1 : 0)) {
+		return;
+	}
+	if (slot == nullptr) {
+		counters.issued++;
+	}
+	if (enabled) {
+		glEnable(capability);
+	}
+	else {
+		glDisable(capability);
+	}
+}
+
+void CachedPolygonMode(GLenum mode) {
+	if (!Unchanged(shadow.polygonMode, mode)) {
+		glPolygonMode(GL_FRONT_AND_BACK, mode);
+	}
+}
+
+void CachedFrontFace(GLenum mode) {
+	if (!Unchanged(shadow.frontFace, mode)) {
+		glFrontFace(mode);
+	}
+}
+
+void CachedCullFace(GLenum mode) {
+	if (!Unchanged(shadow.cullFaceMode, mode)) {
+		glCullFace(mode);
+	}
+}
+
+void CachedDepthFunc(GLenum func) {
+	if (!Unchanged(shadow.depthFunc, func)) {
+		glDepthFunc(func);
+	}
+}
+
+void CachedDepthMask(bool write) {
+	if (!Unchanged(shadow.depthMask, write ? 1 : 0)) {
+		glDepthMask(write ? GL_TRUE : GL_FALSE);
+	}
+}
+
+void CachedColorMask(bool write) {
+	if (!Unchanged(shadow.colorMask, write ? 1 : 0)) {
+		GLboolean mask = write ? GL_TRUE : GL_FALSE;
+		glColorMask(mask, mask, mask, mask);
+	}
+}
+
+void CachedBlendFunc(GLenum source, GLenum destination) {
+	if (shadow.blendSource == source && shadow.blendDestination == destination) {
+		counters.skipped++;
+		return;
+	}
+	Unchanged(shadow.blendSource, source);
+	shadow.blendDestination = destination;
+	glBlendFunc(source, destination);
+}
+
+void CachedDeleteVertexArray(GLuint vao) {
+	if (shadow.vao == vao) {
+		shadow.vao = kUnknown;
+	}
+	glDeleteVertexArrays(1, &vao);
+}
+
+void CachedDeleteTexture(GLuint texture) {
+	for (GLuint unit = 0; unit < kMaxCachedTextureUnits; unit++) {
+		for (int target = 0; target < kTextureTargets; target++) {
+			if (shadow.textures[unit][target] == texture) {
+				shadow.textures[unit][target] = kUnknown;
+			}
+		}
+	}
+	glDeleteTextures(1, &texture);
+}
+
+void InvalidateStateCache() {
+	shadow = UnknownState();
+}
+
+const StateCacheCounters& GetStateCacheCounters() {
+	return counters;
+}
+
+void ResetStateCacheCounters() {
+	counters.issued = 0;
+	counters.skipped = 0;
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include <GL\glew.h>
+
+#ifndef  GLStateCache_h
+#define GLStateCache_h
+
+const GLuint kMaxCachedTextureUnits = 16; // texture units whose bindings are shadowed, higher units are passed through
+
+// GL calls of the current frame that went to the driver and that the cache dropped because nothing changed
+struct StateCacheCounters {
+	unsigned int issued;
+	unsigned int skipped;
+};
+
+// shadowed versions of the state calls of the frame path, each one only reaches the driver when it changes something.
+// Every bind of the tracked state has to go through these, a direct gl call leaves the shadow copy stale
+// (call InvalidateStateCache after code that cannot be routed here, e.g. the framework)
+void CachedUseProgram(GLuint program);
+void CachedBindVertexArray(GLuint vao);
+void CachedActiveTexture(GLuint unit); // unit index, not GL_TEXTUREi
+void CachedBindTexture(GLuint unit, GLenum target, GLuint texture); // GL_TEXTURE_2D, GL_TEXTURE_2D_ARRAY or GL_TEXTURE_CUBE_MAP
+void CachedBindSampler(GLuint unit, GLuint sampler);
+void CachedSetCapability(GLenum capability, bool enabled); // GL_CULL_FACE, GL_DEPTH_TEST and GL_BLEND are cached
+void CachedPolygonMode(GLenum mode); // GL_FRONT_AND_BACK
+void CachedFrontFace(GLenum mode);
+void CachedCullFace(GLenum mode);
+void CachedDepthFunc(GLenum func);
+void CachedDepthMask(bool write);
+void CachedColorMask(bool write); // all four channels
+void CachedBlendFunc(GLenum source, GLenum destination);
+
+// delete the object and forget it in the shadow state, the driver may hand out the name again for a new object
+void CachedDeleteVertexArray(GLuint vao);
+void CachedDeleteTexture(GLuint texture);
+
+// forgets every shadowed value, the next call of each kind is issued
+void InvalidateStateCache();
+
+// counters since the last reset, reset once per frame
+const StateCacheCounters& GetStateCacheCounters();
+void ResetStateCacheCounters();
+
+#endif /GLStateCache_h/
@@ -0,0 +1,110 @@
+#include "GeometryRegistry.h"
+#include <map>
+#include "GLStateCache.h"
+
+static std::map<GeometryKey, Geometry*> registry; // all live geometries
+
+Geometry::Geometry() {
+	Vao = 0;
+	Vbo = 0;
+	Ebo = 0;
+	indexType = GL_NONE;
+	elementCount = 0;
+	indexed = false;
+	references = 0;
+	bounds = MakeBounds(glm::vec3(0.0f), glm::vec3(0.0f));
+}
+
+GeometryKey::GeometryKey(PrimitiveType _type, float dimension0, float dimension1, float dimension2, int segments0, int segments1, bool _indexed, bool _packed) {
+	type = _type;
+	dimensions[0] = dimension0;
+	dimensions[1] = dimension1;
+	dimensions[2] = dimension2;
+	segments[0] = segments0;
+	segments[1] = segments1;
+	indexed = _indexed;
+	packed = _packed;
+}
+
+bool GeometryKey::operator<(const GeometryKey& other) const {
+	if (type != other.type) return type < other.type;
+	for (int i = 0; i < 3; i++) {
+		if (dimensions[i] != other.dimensions[i]) return dimensions[i] < other.dimensions[i];
+	}
+	for (int i = 0; i < 2; i++) {
+		if (segments[i] != other.segments[i]) return segments[i] < other.segments[i];
+	}
+	if (indexed != other.indexed) return indexed < other.indexed;
+	return packed < other.packed;
+}
+
+Geometry* AcquireGeometry(const GeometryKey& key, const std::function<void(Geometry&)>& build) {
+	std::map<GeometryKey, Geometry*>::iterator it = registry.find(key);
+	if (it != registry.end()) { // already built, share it
+		it->second->references++;
+		return it->second;
+	}
+
+	Geometry* geometry = new Geometry();
+	glGenVertexArrays(1, &geometry->Vao); // create the VAO
+	CachedBindVertexArray(geometry->Vao); // bind the VAO
+	glGenBuffers(1, &geometry->Vbo); // generate the VBO
+	glBindBuffer(GL_ARRAY_BUFFER, geometry->Vbo); // bind the VBO
+
+	build(*geometry);
+
+	CachedBindVertexArray(0); // unbind the VAO
+	geometry->references = 1;
+	registry[key] = geometry;
+	return geometry;
+}
+
+void ReleaseGeometry(Geometry* geometry) {
+	if (geometry == nullptr || --geometry->references > 0) {
+		return;
+	}
+
+	for (std::map<GeometryKey, Geometry*>::iterator it = registry.begin(); it != registry.end(); ++it) {
+		if (it->second == geometry) {
+			registry.erase(it);
+			break;
+		}
+	}
+
+	glDeleteBuffers(1, &geometry->Vbo);
+	if (geometry->Ebo != 0) {
+		glDeleteBuffers(1, &geometry->Ebo);
+	}
+	CachedDeleteVertexArray(geometry->Vao);
+	delete geometry;
+}
+
+size_t RegisteredGeometryCount() {
+	return registry.size();
+}
+
+void UploadMeshGeometry(Geometry& geometry, const std::vector<float>& data, const std::vector<float>& vertices, const std::vector<unsigned int>& indices, bool indexed, bool shortIndices, bool packed) {
+	geometry.indexed = indexed;
+	geometry.bounds = indexed ? ComputeBounds(&vertices[0], vertices.size() / 8, 8) : ComputeBounds(&data[0], data.size() / 8, 8);
+	if (!indexed) {
+		UploadVertices(&data[0], data.size() / 8, packed, geometry.quantization); // buffer the vertex data and set the layout
+		geometry.indexType = GL_NONE;
+		geometry.elementCount = (GLsizei)(data.size() / 8);
+		return;
+	}
+
+	UploadVertices(&vertices[0], vertices.size() / 8, packed, geometry.quantization); // buffer the vertex data and set the layout
+
+	glGenBuffers(1, &geometry.Ebo); // generate the EBO
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, geometry.Ebo); // bind the EBO to the VAO
+	if (shortIndices) {
+		std::vector<unsigned short> shortIndexData(indices.begin(), indices.end()); // narrow to 16 bit
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, shortIndexData.size() * sizeof(unsigned short), &shortIndexData[0], GL_STATIC_DRAW);
+		geometry.indexType = GL_UNSIGNED_SHORT;
+	}
+	else {
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
+		geometry.indexType = GL_UNSIGNED_INT;
+	}
+	geometry.elementCount = (GLsizei)indices.size();
+}
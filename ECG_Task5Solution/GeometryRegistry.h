@@ -0,0 +1,59 @@
+#pragma once
+#include <GL\glew.h>
+#include <vector>
+#include <cstddef>
+#include <functional>
+#include "VertexPacking.h"
+#include "BoundingVolume.h"
+
+#ifndef  GeometryRegistry_h
+#define GeometryRegistry_h
+
+enum PrimitiveType {
+	PRIMITIVE_SPHERE,
+	PRIMITIVE_CYLINDER,
+	PRIMITIVE_CUBOID
+};
+
+// GPU side mesh, shared by every primitive built with the same parameters
+class Geometry {
+public:
+	GLuint Vao; // vertex array object
+	GLuint Vbo; // vertex buffer object
+	GLuint Ebo; // element buffer object (indexed only)
+	GLenum indexType; // GL_UNSIGNED_SHORT or GL_UNSIGNED_INT (indexed only)
+	GLsizei elementCount; // number of vertices (or indices if indexed) to draw
+	bool indexed; // draw with glDrawElements instead of glDrawArrays
+	VertexQuantization quantization; // decode parameters of the vertex buffer
+	BoundingVolume bounds; // object space bounds of the vertex data, set by the build function
+	int references; // primitives currently using this geometry
+	Geometry();
+};
+
+// everything that influences the generated vertex data of a primitive
+class GeometryKey {
+public:
+	PrimitiveType type;
+	float dimensions[3]; // radius/length/height/width, unused entries are 0
+	int segments[2]; // tessellation, unused entries are 0
+	bool indexed;
+	bool packed;
+	GeometryKey(PrimitiveType type, float dimension0, float dimension1, float dimension2, int segments0, int segments1, bool indexed, bool packed);
+	bool operator<(const GeometryKey& other) const;
+};
+
+// returns the geometry registered for "key", adding a reference. On first use the VAO and VBO are
+// generated and bound and "build" has to fill them in (vertex data, layout, element count)
+Geometry* AcquireGeometry(const GeometryKey& key, const std::function<void(Geometry&)>& build);
+
+// drops one reference, the GL objects are deleted together with the last one
+void ReleaseGeometry(Geometry* geometry);
+
+// number of distinct geometries currently alive
+size_t RegisteredGeometryCount();
+
+// buffers a triangle list ("data") or an indexed mesh ("vertices" + "indices") into the bound VBO/VAO
+// of "geometry", adding an EBO with 16 or 32 bit indices for the indexed case
+void UploadMeshGeometry(Geometry& geometry, const std::vector<float>& data, const std::vector<float>& vertices, const std::vector<unsigned int>& indices, bool indexed, bool shortIndices, bool packed);
+
+#endif /GeometryRegistry_h/
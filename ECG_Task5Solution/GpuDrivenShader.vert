@@ -0,0 +1,32 @@
+//vertex shader of the GPU driven path, the object of an instance comes from the visible list CullInstances.comp wrote
+#version 430
+layout (location = 0) in vec3 position;
+layout (location = 1) in vec3 normal;
+layout (location = 2) in vec2 uv;
+layout (location = 3) in uint instanceObject; // per instance, the command's baseInstance points at its bucket
+
+#include "FrameData.glsl"
+#include "ObjectData.glsl"
+
+out vec3 Normal;
+out vec3 FragPos;
+out vec2 Uv;
+flat out int ObjectIndex;
+
+#include "Octahedral.glsl"
+
+invariant gl_Position; // the depth pre-pass runs this shader too, GL_EQUAL needs bit identical depth in both passes
+
+void main()
+{
+    ObjectIndex = int(instanceObject);
+    ObjectData object = objects[ObjectIndex];
+
+    vec3 objectPosition = object.positionOffset.xyz + position * object.positionScale.xyz;
+    vec3 objectNormal = object.octahedralNormals != 0 ? DecodeOctahedral(normal.xy) : normal;
+
+    gl_Position = objectMvps[ObjectIndex] * vec4(objectPosition, 1.0); // written by the cull pass of this frame
+    FragPos = vec3(object.model * vec4(objectPosition, 1.0));
+    Normal = object.normalMatrix * objectNormal;
+    Uv = (object.uvOffset + uv * object.uvScale) * object.textureScale;
+}
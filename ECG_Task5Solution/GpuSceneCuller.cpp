@@ -0,0 +1,296 @@
+#include "GpuSceneCuller.h"
+#include <map>
+#include <utility>
+#include "ComputeProgram.h"
+#include "GLStateCache.h"
+#include "VertexPacking.h"
+
+const GLuint kCullGroupSize = 64; // local_size_x of CullInstances.comp
+
+static_assert(sizeof(CullInstance) == 32, "CullInstance has to match the std430 layout of the shader struct");
+static_assert(sizeof(CullLodLevel) == 8, "CullLodLevel has to match the std430 layout of the shader struct");
+
+GpuSceneCuller::GpuSceneCuller(MultiDrawBatch& geometryBatch) : batch(geometryBatch) {
+	cullProgram = LoadComputeProgram("assets/CullInstances.comp");
+	instanceCountLocation = glGetUniformLocation(cullProgram, "instanceCount");
+	viewportHeightLocation = glGetUniformLocation(cullProgram, "viewportHeight");
+	hysteresisLocation = glGetUniformLocation(cullProgram, "hysteresis");
+	occlusionLocation = glGetUniformLocation(cullProgram, "occlusionCulling");
+	pyramidViewProjectionLocation = glGetUniformLocation(cullProgram, "pyramidViewProjection");
+	pyramidSizeLocation = glGetUniformLocation(cullProgram, "pyramidSize");
+	pyramidLevelsLocation = glGetUniformLocation(cullProgram, "pyramidLevels");
+
+	glGenVertexArrays(1, &Vao);
+	glGenBuffers(1, &objectBuffer);
+	glGenBuffers(1, &instanceBuffer);
+	glGenBuffers(1, &lodBuffer);
+	glGenBuffers(1, &commandBuffer);
+	glGenBuffers(1, &commandTemplate);
+	glGenBuffers(1, &visibleBuffer);
+	glGenBuffers(1, &mvpBuffer);
+	glGenBuffers(kStreamSegments, counterBuffers);
+	GLuint zero[3] = { 0, 0, 0 };
+	for (int i = 0; i < kStreamSegments; i++) {
+		glBindBuffer(GL_ATOMIC_COUNTER_BUFFER, counterBuffers[i]);
+		glBufferData(GL_ATOMIC_COUNTER_BUFFER, sizeof(zero), zero, GL_DYNAMIC_READ);
+		counterFences[i] = 0;
+	}
+	glBindBuffer(GL_ATOMIC_COUNTER_BUFFER, 0);
+
+	visible = 0;
+	culled = 0;
+	occluded = 0;
+	drawCalls = 0;
+	frame = 0;
+	hysteresis = 0.0f;
+	batchVersion = 0;
+	dirty = false;
+}
+
+unsigned int GpuSceneCuller::Add(const DrawPacket& packet, const BoundingVolume& bounds, const LodChain* lod) {
+	CullInstance instance;
+	instance.sphere = glm::vec4(bounds.center, bounds.radius);
+	instance.object = (GLuint)instances.size(); // one ObjectData entry per instance
+	instance.firstLod = 0; // filled in by Rebuild
+	instance.lodCount = lod != nullptr ? (GLuint)lod->levels.size() : 1;
+	instance.currentLod = lod != nullptr ? (GLuint)lod->current : 0;
+	instances.push_back(instance);
+	packets.push_back(packet);
+	lods.push_back(lod);
+	if (lod != nullptr) {
+		hysteresis = lod->hysteresis; // a global setting, the same for every chain
+	}
+	dirty = true;
+	return instance.object;
+}
+
+void GpuSceneCuller::Rebuild() {
+	// geometry of every level of every instance has to be in the shared buffers
+	std::vector<std::vector<const Geometry*> > levels(instances.size());
+	for (size_t i = 0; i < instances.size(); i++) {
+		if (lods[i] == nullptr) {
+			levels[i].push_back(packets[i].geometry);
+		}
+		for (size_t level = 0; lods[i] != nullptr && level < lods[i]->levels.size(); level++) {
+			levels[i].push_back(lods[i]->levels[level].geometry);
+		}
+		for (size_t level = 0; level < levels[i].size(); level++) {
+			batch.AddGeometry(levels[i][level]);
+		}
+	}
+	batch.UpdateGeometry();
+	batchVersion = batch.geometryVersion;
+
+	// one bucket per texture and geometry, the map orders them by texture so every texture is one run.
+	// A bucket has room for every instance that could pick it
+	std::map<std::pair<GLuint, const Geometry*>, GLuint> capacities;
+	std::map<GLuint, GLenum> targets;
+	for (size_t i = 0; i < instances.size(); i++) {
+		for (size_t level = 0; level < levels[i].size(); level++) {
+			capacities[std::make_pair(packets[i].texture, levels[i][level])]++;
+		}
+		targets[packets[i].texture] = packets[i].textureTarget;
+	}
+
+	std::map<std::pair<GLuint, const Geometry*>, GLuint> buckets;
+	std::vector<DrawElementsIndirectCommand> commands;
+	GLuint visibleSlots = 0;
+	bucketTextures.clear();
+	bucketTargets.clear();
+	runStarts.clear();
+	for (std::map<std::pair<GLuint, const Geometry*>, GLuint>::iterator it = capacities.begin(); it != capacities.end(); ++it) {
+		if (bucketTextures.empty() || bucketTextures.back() != it->first.first) {
+			runStarts.push_back((GLsizei)commands.size());
+		}
+		buckets[it->first] = (GLuint)commands.size();
+		bucketTextures.push_back(it->first.first);
+		bucketTargets.push_back(targets[it->first.first]);
+
+		const GeometryRange& range = batch.Range(it->first.second);
+		DrawElementsIndirectCommand command;
+		command.count = range.indexCount;
+		command.instanceCount = 0; // counted up by the cull pass
+		command.firstIndex = range.firstIndex;
+		command.baseVertex = range.baseVertex;
+		command.baseInstance = visibleSlots; // start of the bucket's slice of the visible list
+		commands.push_back(command);
+		visibleSlots += it->second;
+	}
+
+	// the buffer outlives the camera, so only the normal matrices are taken from the batch,
+	// the MVPs are written per frame by the cull pass
+	TransformBatch transforms;
+	for (size_t i = 0; i < instances.size(); i++) {
+		transforms.Add(*packets[i].transform);
+	}
+	transforms.Compute(glm::mat4(1.0f));
+
+	std::vector<CullLodLevel> lodTable;
+	std::vector<ObjectData> objects(instances.size());
+	for (size_t i = 0; i < instances.size(); i++) {
+		instances[i].firstLod = (GLuint)lodTable.size();
+		for (size_t level = 0; level < levels[i].size(); level++) {
+			CullLodLevel entry;
+			entry.bucket = buckets[std::make_pair(packets[i].texture, levels[i][level])];
+			entry.switchRadius = lods[i] != nullptr ? lods[i]->SwitchRadius((int)level) : 0.0f;
+			lodTable.push_back(entry);
+		}
+		DrawPacket packet = packets[i];
+		packet.geometry = levels[i][0]; // float vertices, the decode parameters are identity for every level
+		objects[i] = MakeObjectData(packet, transforms.transforms[i]);
+	}
+
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, objectBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, objects.size() * sizeof(ObjectData), &objects[0], GL_STATIC_DRAW); // only UpdateTransform writes it again
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, instanceBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, instances.size() * sizeof(CullInstance), &instances[0], GL_DYNAMIC_COPY); // currentLod is written back on the GPU
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, lodBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, lodTable.size() * sizeof(CullLodLevel), &lodTable[0], GL_STATIC_DRAW);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, visibleBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, visibleSlots * sizeof(GLuint), nullptr, GL_DYNAMIC_COPY); // written and read on the GPU only
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, mvpBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, instances.size() * sizeof(glm::mat4), nullptr, GL_DYNAMIC_COPY); // written and read on the GPU only
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, commandTemplate);
+	glBufferData(GL_COPY_WRITE_BUFFER, commands.size() * sizeof(DrawElementsIndirectCommand), &commands[0], GL_STATIC_COPY);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, commandBuffer);
+	glBufferData(GL_COPY_WRITE_BUFFER, commands.size() * sizeof(DrawElementsIndirectCommand), nullptr, GL_DYNAMIC_COPY);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+	// the batch's vertex layout plus the visible list as a per instance attribute, baseInstance offsets it per command
+	CachedBindVertexArray(Vao);
+	glBindBuffer(GL_ARRAY_BUFFER, batch.Vbo);
+	SetVertexLayout(false);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, batch.Ebo); // bind the EBO to the VAO
+	glBindBuffer(GL_ARRAY_BUFFER, visibleBuffer);
+	glEnableVertexAttribArray(3);
+	glVertexAttribIPointer(3, 1, GL_UNSIGNED_INT, sizeof(GLuint), (void*)0);
+	glVertexAttribDivisor(3, 1);
+
+	dirty = false;
+}
+
+void GpuSceneCuller::UpdateTransform(unsigned int instance) {
+	if (dirty) {
+		return; // Rebuild uploads every object anyway
+	}
+	DrawPacket packet = packets[instance];
+	packet.geometry = lods[instance] != nullptr ? lods[instance]->levels[0].geometry : packet.geometry;
+	ObjectData object = MakeObjectData(packet, MakeObjectTransform(*packet.transform, glm::mat4(1.0f)));
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, objectBuffer);
+	glBufferSubData(GL_SHADER_STORAGE_BUFFER, instance * sizeof(ObjectData), sizeof(ObjectData), &object);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+void GpuSceneCuller::Cull(int viewportHeight, DepthPyramid* pyramid) {
+	if (instances.empty()) {
+		return;
+	}
+	batch.UpdateGeometry();
+	if (dirty || batch.geometryVersion != batchVersion) { // new instances, or the batch moved the shared geometry
+		Rebuild();
+	}
+
+	// instanceCount back to 0, GPU to GPU
+	GLsizeiptr commandBytes = bucketTextures.size() * sizeof(DrawElementsIndirectCommand);
+	glBindBuffer(GL_COPY_READ_BUFFER, commandTemplate);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, commandBuffer);
+	glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, commandBytes);
+	glBindBuffer(GL_COPY_READ_BUFFER, 0);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+	// counters of the oldest buffer, read only once its fence says the cull pass finished so the readback never
+	// waits for the GPU. If it is still running the stats keep their previous values
+	int slot = frame % kStreamSegments;
+	if (counterFences[slot] != 0) {
+		if (glClientWaitSync(counterFences[slot], 0, 0) != GL_TIMEOUT_EXPIRED) {
+			GLuint counters[3];
+			glBindBuffer(GL_ATOMIC_COUNTER_BUFFER, counterBuffers[slot]);
+			glGetBufferSubData(GL_ATOMIC_COUNTER_BUFFER, 0, sizeof(counters), counters);
+			visible = counters[0];
+			culled = counters[1];
+			occluded = counters[2];
+		}
+		glDeleteSync(counterFences[slot]);
+		counterFences[slot] = 0;
+	}
+	GLuint zero[3] = { 0, 0, 0 };
+	glBindBuffer(GL_ATOMIC_COUNTER_BUFFER, counterBuffers[slot]);
+	glBufferSubData(GL_ATOMIC_COUNTER_BUFFER, 0, sizeof(zero), zero);
+	glBindBuffer(GL_ATOMIC_COUNTER_BUFFER, 0);
+	glBindBufferBase(GL_ATOMIC_COUNTER_BUFFER, kCullCounterBinding, counterBuffers[slot]);
+	frame++;
+
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, kObjectDataBinding, objectBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, kCullInstanceBinding, instanceBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, kCullLodBinding, lodBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, kCullCommandBinding, commandBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, kCullVisibleBinding, visibleBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, kObjectMvpBinding, mvpBuffer);
+
+	CachedUseProgram(cullProgram);
+	glUniform1ui(instanceCountLocation, (GLuint)instances.size());
+	glUniform1f(viewportHeightLocation, (float)viewportHeight);
+	glUniform1f(hysteresisLocation, hysteresis);
+	bool occlusion = pyramid != nullptr && pyramid->valid;
+	glUniform1i(occlusionLocation, occlusion ? 1 : 0);
+	if (occlusion) {
+		pyramid->Bind();
+		glUniformMatrix4fv(pyramidViewProjectionLocation, 1, GL_FALSE, &pyramid->viewProjection[0][0]);
+		glUniform2f(pyramidSizeLocation, (float)pyramid->width, (float)pyramid->height);
+		glUniform1i(pyramidLevelsLocation, pyramid->levels);
+	}
+	glDispatchCompute(((GLuint)instances.size() + kCullGroupSize - 1) / kCullGroupSize, 1, 1);
+	// the draw reads the commands, the visible list and the MVPs, the next Cull reads the counters back and resets the commands
+	// with buffer calls, and its dispatch reads currentLod for the hysteresis
+	glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+	counterFences[slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0); // the counters of this frame are final once it signals
+}
+
+void GpuSceneCuller::Draw(bool bindTextures) {
+	drawCalls = 0;
+	if (instances.empty()) {
+		return;
+	}
+
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, kObjectDataBinding, objectBuffer); // the multi-draw batch binds its own per frame data here
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, kObjectMvpBinding, mvpBuffer);
+	CachedBindVertexArray(Vao);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+	if (!bindTextures) { // depth only, one call over every bucket
+		glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (void*)0, (GLsizei)bucketTextures.size(), 0);
+		drawCalls++;
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+		return;
+	}
+	for (size_t run = 0; run < runStarts.size(); run++) {
+		GLsizei first = runStarts[run];
+		GLsizei count = (run + 1 < runStarts.size() ? runStarts[run + 1] : (GLsizei)bucketTextures.size()) - first;
+		CachedBindTexture(bucketTargets[first] == GL_TEXTURE_2D_ARRAY ? 1 : 0, bucketTargets[first], bucketTextures[first]);
+		glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (void*)(first * sizeof(DrawElementsIndirectCommand)), count, 0); // empty buckets draw nothing
+		drawCalls++;
+	}
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
+
+void GpuSceneCuller::Release() {
+	glDeleteProgram(cullProgram);
+	CachedDeleteVertexArray(Vao);
+	glDeleteBuffers(1, &objectBuffer);
+	glDeleteBuffers(1, &instanceBuffer);
+	glDeleteBuffers(1, &lodBuffer);
+	glDeleteBuffers(1, &commandBuffer);
+	glDeleteBuffers(1, &commandTemplate);
+	glDeleteBuffers(1, &visibleBuffer);
+	glDeleteBuffers(1, &mvpBuffer);
+	glDeleteBuffers(kStreamSegments, counterBuffers);
+	for (int i = 0; i < kStreamSegments; i++) {
+		if (counterFences[i] != 0) {
+			glDeleteSync(counterFences[i]);
+			counterFences[i] = 0;
+		}
+	}
+	instances.clear();
+	packets.clear();
+	lods.clear();
+}
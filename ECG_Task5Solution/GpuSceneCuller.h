@@ -0,0 +1,89 @@
+#pragma once
+#include <GL\glew.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include "MultiDrawBatch.h"
+#include "LevelOfDetail.h"
+#include "BoundingVolume.h"
+#include "DepthPyramid.h"
+
+#ifndef  GpuSceneCuller_h
+#define GpuSceneCuller_h
+
+// shader storage bindings of CullInstances.comp, ObjectData keeps kObjectDataBinding
+const GLuint kCullInstanceBinding = 2;
+const GLuint kCullLodBinding = 3;
+const GLuint kCullCommandBinding = 4;
+const GLuint kCullVisibleBinding = 5;
+const GLuint kCullCounterBinding = 0; // atomic counter buffer: visible, culled, occluded
+
+// per instance input of the cull pass, mirrors the std430 CullInstance struct of CullInstances.comp
+struct CullInstance {
+	glm::vec4 sphere; // object space bounding sphere, xyz center, w radius
+	GLuint object; // index into ObjectBuffer, the model matrix comes from there
+	GLuint firstLod; // first entry in the LOD buffer
+	GLuint lodCount;
+	GLuint currentLod; // level drawn last frame, written by the cull pass for the hysteresis
+};
+
+// one LOD level of an instance
+struct CullLodLevel {
+	GLuint bucket; // draw command of the level's geometry and the instance's texture
+	float switchRadius; // LodChain::SwitchRadius of the level
+};
+
+// GPU driven culling and LOD selection. Objects are registered once, after that the CPU cost of a frame is
+// a buffer copy, one dispatch and one glMultiDrawElementsIndirect per texture no matter how many objects there are.
+// The cull pass tests each instance's bounding sphere against the frustum of the FrameData block, picks a level
+// with the same hysteresis rule as LodChain::Select and appends the object to the draw command of its
+// (geometry, texture) bucket with an atomic add on instanceCount. The draw reads the object index as an instanced
+// vertex attribute, so the command's baseInstance selects the bucket's slice of the visible list.
+// With a depth pyramid, instances inside the frustum are also tested against last frame's depth (Hi-Z occlusion).
+// Geometry lives in the shared buffers of a MultiDrawBatch, only float vertices are supported because
+// the decode parameters of packed vertices differ between LOD levels.
+class GpuSceneCuller {
+public:
+	unsigned int visible; // instances drawn, read back kStreamSegments frames late
+	unsigned int culled; // instances outside the frustum, read back kStreamSegments frames late
+	unsigned int occluded; // instances inside the frustum but hidden in the depth pyramid, read back kStreamSegments frames late
+	unsigned int drawCalls; // glMultiDrawElementsIndirect calls of the last Draw
+	GpuSceneCuller(MultiDrawBatch& geometryBatch); // loads the cull program, needs a current GL context
+	unsigned int Add(const DrawPacket& packet, const BoundingVolume& bounds, const LodChain* lod = nullptr); // registers an object, "lod" nullptr draws packet.geometry only
+	void UpdateTransform(unsigned int instance); // re-reads the transform of an instance after its object moved
+	void Cull(int viewportHeight, DepthPyramid* pyramid = nullptr); // runs the cull pass, FrameData has to be bound. Occlusion culling needs a built pyramid
+	void Draw(bool bindTextures = true); // draws the visible instances with the bound GpuDrivenShader program, without textures as one call
+	void Release(); // deletes the GL objects
+private:
+	MultiDrawBatch& batch; // owner of the shared VBO/EBO
+	GLuint cullProgram;
+	GLint instanceCountLocation;
+	GLint viewportHeightLocation;
+	GLint hysteresisLocation;
+	GLint occlusionLocation;
+	GLint pyramidViewProjectionLocation;
+	GLint pyramidSizeLocation;
+	GLint pyramidLevelsLocation;
+	GLuint Vao; // shared vertex layout plus the visible list at location 3
+	GLuint objectBuffer; // ObjectData of every instance
+	GLuint instanceBuffer; // CullInstance
+	GLuint lodBuffer; // CullLodLevel
+	GLuint commandBuffer; // DrawElementsIndirectCommand per bucket, instanceCount filled in by the cull pass
+	GLuint commandTemplate; // the same commands with instanceCount 0, copied over commandBuffer every frame
+	GLuint visibleBuffer; // object indices, one slice per bucket
+	GLuint mvpBuffer; // mat4 per object, written by the cull pass for the visible instances
+	GLuint counterBuffers[kStreamSegments]; // atomic counters, one per frame in flight so the oldest can be read while newer ones are written
+	GLsync counterFences[kStreamSegments]; // signaled when the cull pass of the buffer finished, 0 before its first use
+	int frame;
+	float hysteresis;
+	std::vector<DrawPacket> packets; // one per instance
+	std::vector<const LodChain*> lods; // one per instance, may be nullptr
+	std::vector<CullInstance> instances;
+	std::vector<GLuint> bucketTextures; // per bucket, sorted
+	std::vector<GLenum> bucketTargets;
+	std::vector<GLsizei> runStarts; // first bucket of each texture
+	unsigned int batchVersion; // geometryVersion of the batch the commands were built against
+	bool dirty; // instances were added since the last Rebuild
+	void Rebuild(); // buckets, commands, LOD table and instance buffers
+};
+
+#endif /GpuSceneCuller_h/
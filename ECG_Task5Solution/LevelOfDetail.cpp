@@ -0,0 +1,68 @@
+#include "LevelOfDetail.h"
+#include <cfloat>
+#include <cmath>
+
+const float kTwoPi = 6.28318530718f;
+
+LodLevel::LodLevel(Geometry* _geometry, int _segments) {
+	geometry = _geometry;
+	segments = _segments;
+}
+
+LodChain::LodChain() {
+	current = 0;
+	edgePixels = 10.0f;
+	hysteresis = 0.15f;
+}
+
+void LodChain::AddLevel(Geometry* geometry, int segments) {
+	levels.push_back(LodLevel(geometry, segments));
+}
+
+float LodChain::SwitchRadius(int level) const {
+	if (level + 1 >= (int)levels.size()) {
+		return 0.0f; // the coarsest level is never too fine
+	}
+	// the next coarser level would put edges of 2*pi*r/segments pixels on screen, keep this one while they exceed edgePixels
+	return levels[level + 1].segments * edgePixels / kTwoPi;
+}
+
+Geometry* LodChain::Select(float screenRadius) {
+	if (levels.empty()) {
+		return nullptr;
+	}
+	if (current >= (int)levels.size()) {
+		current = (int)levels.size() - 1;
+	}
+
+	// a switch only happens once the radius is clearly past the threshold, so objects near it don't pop every frame
+	while (current > 0 && screenRadius > SwitchRadius(current - 1) * (1.0f + hysteresis)) {
+		current--; // grown on screen, refine
+	}
+	while (current + 1 < (int)levels.size() && screenRadius < SwitchRadius(current) * (1.0f - hysteresis)) {
+		current++; // shrunk on screen, coarsen
+	}
+	return levels[current].geometry;
+}
+
+int LodChain::CurrentSegments() {
+	return levels.empty() ? 0 : levels[current].segments;
+}
+
+void LodChain::Release() {
+	for (size_t i = 0; i < levels.size(); i++) {
+		ReleaseGeometry(levels[i].geometry);
+	}
+	levels.clear();
+	current = 0;
+}
+
+float ProjectedScreenRadius(const glm::mat4& projection, glm::vec3 cameraPosition, glm::vec3 center, float radius, int viewportHeight) {
+	float distance = glm::length(center - cameraPosition);
+	if (distance <= radius) {
+		return FLT_MAX; // camera inside the bounds
+	}
+	// projection[1][1] is cot(fovy / 2), the tangent distance keeps the silhouette exact for close spheres
+	float tangentDistance = std::sqrt(distance * distance - radius * radius);
+	return radius * projection[1][1] / tangentDistance * 0.5f * viewportHeight;
+}
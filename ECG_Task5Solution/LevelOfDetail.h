@@ -0,0 +1,35 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <vector>
+#include "GeometryRegistry.h"
+
+#ifndef  LevelOfDetail_h
+#define LevelOfDetail_h
+
+// one tessellation level of a primitive
+class LodLevel {
+public:
+	Geometry* geometry; // shared VAO/VBO of this level
+	int segments; // segments around the primitive, used to derive the switch distance
+	LodLevel(Geometry* geometry, int segments);
+};
+
+// levels of a primitive from finest to coarsest, the active one is picked each frame from the projected size
+class LodChain {
+public:
+	std::vector<LodLevel> levels; // finest level first
+	int current; // index of the level drawn last frame
+	float edgePixels; // wanted on-screen length of a segment edge in pixels
+	float hysteresis; // fraction the projected radius has to pass a threshold by before switching
+	LodChain();
+	void AddLevel(Geometry* geometry, int segments); // appends a coarser level
+	float SwitchRadius(int level) const; // projected radius in pixels below which "level" is too fine
+	Geometry* Select(float screenRadius); // updates current and returns its geometry
+	int CurrentSegments(); // segments of the active level
+	void Release(); // releases the geometry of every level
+};
+
+// radius in pixels of a bounding sphere ("center", "radius") seen from "cameraPosition" through "projection"
+float ProjectedScreenRadius(const glm::mat4& projection, glm::vec3 cameraPosition, glm::vec3 center, float radius, int viewportHeight);
+
+#endif /LevelOfDetail_h/
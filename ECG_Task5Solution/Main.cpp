@@ -12,6 +12,8 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <vector>
+#include <random>
+#include <algorithm>
 #include "Texture.h"
 #include "Material.h"
 #include "BasicCubeMesh.h"
@@ -24,110 +26,70 @@
 #include "CuboidMesh.h"
 #include "Cuboid.h"
 #include "OrbitalCamera.h"
+#include "ProceduralMesh.h"
+#include "RenderQueue.h"
+#include "FrameUniformBuffer.h"
+#include "MultiDrawBatch.h"
+#include "StreamRingBuffer.h"
+#include "GLStateCache.h"
+#include "TextureArray.h"
+#include "FrustumCuller.h"
+#include "GpuSceneCuller.h"
+#include "DepthPyramid.h"
+#include "SamplesPassedQuery.h"
+#include "ClusteredLighting.h"
+#include "GBuffer.h"
+#include "ShaderPermutation.h"
+#include "TransformBatch.h"
+#include "ProgramBinaryCache.h"
 
 // Prototypes 
 void APIENTRY DebugCallback(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, const GLchar* message, const GLvoid* userParam);
 static std::string FormatDebugOutput(GLenum source, GLenum type, GLuint id, GLenum severity, const char* msg);
 
+// what an opaque pass writes, every lit shader has a program per pass
+enum RenderPass {
+	PASS_SHADED, // lit color into the bound framebuffer
+	PASS_DEPTH, // depth only, the pre-pass
+	PASS_GBUFFER // surface data into the G-buffer of the deferred path
+};
+
 class Shader {
 public:
 	GLuint program;
-	GLint view;
-	GLint proj;
 	GLint model;
+	GLint mvp;
+	GLint normalMatrix;
+	GLint textureScale;
 	GLint materialColor;
 	GLint pointLightColor;
-	GLint pointLightPosition;
-	GLint viewPosition;
 	GLint k_ambient;
 	GLint k_diffuse;
 	GLint k_specular;
-	GLint directionalLightColor;
-	GLint directionalLightDirection;
-	GLint k_constant;
-	GLint k_linear;
-	GLint k_quadratic;
 	GLint textureLocation;
+	GLint textureArrayLocation;
+	GLint textureLayer;
 	GLint alpha;
-	std::string type;
-	Shader::Shader(std::string relativePathVert, std::string relativePathFrag, std::string _type);
+	GLint positionOffset;
+	GLint positionScale;
+	GLint uvOffset;
+	GLint uvScale;
+	GLint octahedralNormals;
+	GLint primitiveType;
+	GLint primitiveSegments;
+	GLint drawOffset;
+	const Shader* depthShader; // program of the depth pre-pass, same vertex shader with the SHADER_DEPTH_ONLY variant
+	const Shader* gbufferShader; // program of the deferred geometry pass, same vertex shader with the SHADER_GBUFFER variant
+	unsigned int features; // ShaderFeature bits the program was compiled with
+	Shader::Shader(std::string relativePathVert, std::string relativePathFrag, unsigned int _features);
 
 
 };
-Shader::Shader(string relativePathVert, string relativePathFrag, string _type) {
-	type = _type;
-	// Compile Vertex Shader 
-	const char* vertexSource; // create character list
-	GLuint vertexShader; // create vertex shader id
-	std::ifstream is_vs(relativePathVert); // read shader file
-	const std::string f_vs((std::istreambuf_iterator<char>(is_vs)), std::istreambuf_iterator<char>()); // string buffer
-	vertexSource = f_vs.c_str(); // convert character list to string
-	vertexShader = glCreateShader(GL_VERTEX_SHADER); // Create an empty vertex shader handle
-	glShaderSource(vertexShader, 1, &vertexSource, 0); // link source
-	glCompileShader(vertexShader); // Compile the vertex shader
-
-	// Check for vs errors
-	GLint succeded_vs;
-	glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &succeded_vs);
-	if (succeded_vs == GL_FALSE) {
-		GLint logSize;
-		glGetShaderiv(vertexShader, GL_INFO_LOG_LENGTH, &logSize);
-		GLchar* message = new char[logSize];
-		glGetShaderInfoLog(vertexShader, logSize, NULL, message);
-		std::cerr << message;
-		delete[] message;
-	}
-
-	// Compile Fragment Shader 
-	const char* fragmentSource; // create character list 
-	GLuint fragmentShader; // create frament shader id
-	std::ifstream is_fs(relativePathFrag);// read shader file
-	const std::string f_fs((std::istreambuf_iterator<char>(is_fs)), std::istreambuf_iterator<char>()); // string buffer
-	fragmentSource = f_fs.c_str(); // conver character list to string
-	fragmentShader = glCreateShader(GL_FRAGMENT_SHADER); // Create an empty vertex shader handle
-	glShaderSource(fragmentShader, 1, &fragmentSource, 0); //link source
-	glCompileShader(fragmentShader); // Compile the fragment shader
-
-	// Check for fs errors
-	GLint succeded_fs;
-	glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &succeded_fs);
-	if (succeded_fs == GL_FALSE) {
-		GLint logSize;
-		glGetShaderiv(fragmentShader, GL_INFO_LOG_LENGTH, &logSize);
-		GLchar* message = new char[logSize];
-		glGetShaderInfoLog(fragmentShader, logSize, NULL, message);
-		std::cerr << message;
-		delete[] message;
-	}
-
-	// Compile Shader Program 
-
-	program = glCreateProgram(); // create program
-	glAttachShader(program, vertexShader); // attach shader
-	glAttachShader(program, fragmentShader); // attach shader
-	glLinkProgram(program); // link program
-
-	// check for sp errors
-	int IsLinked;
-	int maxLength;
-	char* shaderProgramInfoLog;
-	glGetProgramiv(program, GL_LINK_STATUS, (int*)&IsLinked);
-	if (IsLinked == FALSE)
-	{
-		/* Noticed that glGetProgramiv is used to get the length for a shader program, not glGetShaderiv. */
-		glGetProgramiv(program, GL_INFO_LOG_LENGTH, &maxLength);
-
-		/* The maxLength includes the NULL character */
-		shaderProgramInfoLog = (char*)malloc(maxLength);
-
-		/* Notice that glGetProgramInfoLog, not glGetShaderInfoLog. */
-		glGetProgramInfoLog(program, maxLength, &maxLength, shaderProgramInfoLog);
-
-		std::cerr << shaderProgramInfoLog; // display the error log
-		free(shaderProgramInfoLog);
-	}
-
-
+Shader::Shader(string relativePathVert, string relativePathFrag, unsigned int _features) {
+	features = _features;
+	depthShader = nullptr;
+	gbufferShader = nullptr;
+	program = AcquireShaderProgram(relativePathVert, relativePathFrag, features); // assembled from the chunks, compiled once per variant
 
 	// register debug callback
 #if _DEBUG
@@ -135,38 +97,32 @@ Shader::Shader(string relativePathVert, string relativePathFrag, string _type) {
 	glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);  // Enable synchronous callback. This ensures that your callback function is called right after an error has occurred. 
 #endif
 
-		// get shader program uniform/attribute IDs
-	view = glGetUniformLocation(program, "view"); // get uniform ID for view matrix
-	proj = glGetUniformLocation(program, "proj"); // get uniform ID for projection matrix 
+	// get shader program uniform/attribute IDs, uniforms a variant does not have are -1 and ignored by glUniform
 	model = glGetUniformLocation(program, "model"); // get uniform ID for model matrix
-
-	if (type == "phong" || "gourad") {
-		materialColor = glGetUniformLocation(program, "materialColor"); // get uniform ID for out-color vector
-		viewPosition = glGetUniformLocation(program, "viewPos"); // get uniform ID for 
-
-		pointLightPosition = glGetUniformLocation(program, "pLightPosition"); // get uniform ID for 
-		pointLightColor = glGetUniformLocation(program, "pLightColor"); // get uniform ID for 
-
-		directionalLightColor = glGetUniformLocation(program, "dLightColor"); // get uniform ID for 
-		directionalLightDirection = glGetUniformLocation(program, "dLightDirection"); // get uniform ID for 
-
-		k_ambient = glGetUniformLocation(program, "k_ambient"); // get uniform ID for 
-		k_diffuse = glGetUniformLocation(program, "k_diffuse"); // get uniform ID for 
-		k_specular = glGetUniformLocation(program, "k_specular"); // get uniform ID for 
-
-		k_linear = glGetUniformLocation(program, "k_linear"); // get uniform ID for 
-		k_constant = glGetUniformLocation(program, "k_constant"); // get uniform ID for 
-		k_quadratic = glGetUniformLocation(program, "k_quadratic"); // get uniform ID for 
-		alpha = glGetUniformLocation(program, "alpha");
-
-	}
-	if (type == "basic") {
-		pointLightColor = glGetUniformLocation(program, "color"); // get uniform ID for 
-	}
-	if (type == "phong") {
-		textureLocation = glGetUniformLocation(program, "colorTexture");
-	}
-
+	mvp = glGetUniformLocation(program, "mvp"); // get uniform ID for the model view projection matrix
+	normalMatrix = glGetUniformLocation(program, "normalMatrix"); // get uniform ID for normal matrix
+	textureScale = glGetUniformLocation(program, "textureScale"); // get uniform ID for the uv repeat
+	primitiveType = glGetUniformLocation(program, "primitiveType"); // get uniform IDs of the procedural primitive (-1 in other programs)
+	primitiveSegments = glGetUniformLocation(program, "primitiveSegments");
+	drawOffset = glGetUniformLocation(program, "drawOffset"); // get uniform ID of the first command of a multi-draw call (-1 in other programs)
+
+	materialColor = glGetUniformLocation(program, "materialColor"); // get uniform ID for out-color vector
+	k_ambient = glGetUniformLocation(program, "k_ambient"); // get uniform ID for 
+	k_diffuse = glGetUniformLocation(program, "k_diffuse"); // get uniform ID for 
+	k_specular = glGetUniformLocation(program, "k_specular"); // get uniform ID for 
+	alpha = glGetUniformLocation(program, "alpha");
+
+	positionOffset = glGetUniformLocation(program, "positionOffset"); // get uniform IDs for the packed vertex decode parameters
+	positionScale = glGetUniformLocation(program, "positionScale");
+	uvOffset = glGetUniformLocation(program, "uvOffset");
+	uvScale = glGetUniformLocation(program, "uvScale");
+	octahedralNormals = glGetUniformLocation(program, "octahedralNormals");
+
+	pointLightColor = glGetUniformLocation(program, "color"); // get uniform ID for 
+
+	textureLocation = glGetUniformLocation(program, "colorTexture");
+	textureArrayLocation = glGetUniformLocation(program, "colorTextureArray");
+	textureLayer = glGetUniformLocation(program, "textureLayer");
 }
 
 struct Vectors { // Shorthand representation of 3D vectors in this engine
@@ -208,10 +164,11 @@ glm::mat4 Camera_LookAt(glm::vec3 eye, glm::vec3 target, glm::vec3 up);
 void window_onMouseDown(GLFWwindow* window);
 void Window_onMouseRelease();
 double DegreesToRadians(double degrees);
-void RenderCuboid(Cuboid object, Shader shader, glm::mat4 viewMatrix, OrbitalCamera camera, PointLightSource pLightSource, DirectionalLightSource dLightSource);
-void RenderSphere(Sphere object, Shader shader, glm::mat4 viewMatrix, OrbitalCamera camera, PointLightSource pLightSource, DirectionalLightSource dLightSource);
-void RenderCylinder(Cylinder object, Shader shader, glm::mat4 viewMatrix, OrbitalCamera camera, PointLightSource pLightSource, DirectionalLightSource dLightSource);
-void RenderPointLightSource(PointLightSource pLightSource, Shader shader, glm::mat4 viewMatrix, OrbitalCamera camera);
+void SubmitDrawPacket(DrawPacket packet, const Shader& shader, RenderQueue& queue, MultiDrawBatch& batch, TransformBatch& transforms, bool multiDraw, glm::vec3 cameraPosition);
+const Shader& PassShader(const Shader& shader, RenderPass pass);
+void ExecuteRenderQueue(const RenderQueue& queue, const TransformBatch& transforms, RenderPass pass = PASS_SHADED);
+void RenderPointLightSource(PointLightSource pLightSource, Shader shader);
+void PushVertexQuantization(const Shader& shader, const VertexQuantization& quantization);
 
 #define M_PI std::acos(-1.0)
 
@@ -222,6 +179,7 @@ const double PI = std::acos(-1.0);
 
 bool wireframeMode = false;
 bool backFaceCullingMode = false;
+int depthPyramidDebugLevel = -1; // pyramid level shown over the frame, -1 is off
 
 // Main 
 int main(int argc, char** argv)
@@ -234,11 +192,29 @@ int main(int argc, char** argv)
 	int refresh_rate = reader.GetInteger("window", "refresh_rate", 60); // frames per second value
 	double max_period = 10 / refresh_rate; // updates per second value
 	double lastTime = 0.0; // helper variable for managing FPS
+	double statsTime = 0.0; // last time the frame stats were written to the window title
 	std::string fullscreen = reader.Get("window", "fullscreen", "false"); // fullscreen pseudo bool
 	std::string window_title = reader.Get("window", "title", "ECG 2020"); // window title
 	double fovy = reader.GetReal("camera", "fov", 60.0); // field of view
 	double zNear = reader.GetReal("camera", "near", 0.1); // perspective near clipping plane
 	double zFar = reader.GetReal("camera", "far", 100.0); // perspective far clipping plane
+	bool packedVertices = reader.GetBoolean("mesh", "packed_vertices", false); // 16 byte quantized vertices instead of 32 byte floats
+	bool proceduralMeshes = reader.GetBoolean("mesh", "procedural", false); // build spheres/cylinders in the vertex shader, no vertex buffers
+	int lodLevels = glm::clamp((int)reader.GetInteger("lod", "levels", 4), 1, 5); // tessellation levels per sphere/cylinder, level 0 always exists
+	float lodEdgePixels = (float)reader.GetReal("lod", "edge_pixels", 10.0); // wanted on-screen segment length
+	float lodHysteresis = (float)reader.GetReal("lod", "hysteresis", 0.15); // margin around the switch radius against popping
+	bool multiDraw = reader.GetBoolean("render", "multi_draw", true); // draw all buffered meshes with glMultiDrawElementsIndirect
+	int streamSegmentKb = reader.GetInteger("render", "stream_segment_kb", 256); // per frame room in the persistently mapped ring
+	bool frustumCulling = reader.GetBoolean("render", "frustum_culling", true); // skip objects whose bounds are outside the view frustum
+	bool gpuCulling = reader.GetBoolean("render", "gpu_culling", false); // frustum culling and LOD selection in a compute pass, for very large scenes
+	bool hizOcclusion = reader.GetBoolean("render", "hiz_occlusion", true); // test the GPU cull pass instances against last frame's depth pyramid
+	bool depthPrepass = reader.GetBoolean("render", "depth_prepass", false); // lay down depth first, then shade only the visible fragment of each pixel
+	int scatteredLights = reader.GetInteger("lights", "point_lights", 512); // small point lights around the scene besides the movable one
+	bool deferredShading = reader.GetBoolean("render", "deferred", false); // G-buffer and light volumes instead of the clustered forward Phong shaders
+	std::string gbufferNormals = reader.Get("render", "gbuffer_normals", "rg16"); // normal target of the G-buffer: rg8, rg16 or rg16f
+	std::string gbufferDepth = reader.Get("render", "gbuffer_depth", "d32f"); // depth target of the G-buffer: d32f or d24
+	bool textureArrays = reader.GetBoolean("texture", "array_atlas", true); // pack same size DDS textures into texture arrays
+	bool programCache = reader.GetBoolean("render", "program_cache", true); // keep linked program binaries on disk, skips compiling on the next start
 
 	// Initialize scene 
 	if (!glfwInit()) { // initialize GLFW
@@ -277,6 +253,9 @@ int main(int argc, char** argv)
 		std::cerr << "ERROR: GLEW failed to initialize"; // if GLEW failed to initialize then deliver Error message... 
 		return 0; //...and Exit program
 	}
+	multiDraw = multiDraw && GLEW_ARB_shader_draw_parameters; // BatchedShader.vert needs gl_DrawIDARB
+	gpuCulling = gpuCulling && multiDraw && !packedVertices && !proceduralMeshes; // draws from the multi-draw geometry, float vertex buffers only
+	hizOcclusion = hizOcclusion && gpuCulling; // part of the GPU cull pass
 
 	// Init ECG framework 
 	if (!initFramework()) {
@@ -290,11 +269,48 @@ int main(int argc, char** argv)
 
 
 	//make shaders
-	Shader phongShader("assets/PhongShader.vert", "assets/PhongShader.frag", "phong");
-	Shader gouradShader("assets/GouradShader.vert", "assets/GouradShader.frag", "gourad");
-	Shader basicShader("assets/BasicShader.vert", "assets/BasicShader.frag", "basic");
+	EnableProgramCache(programCache); // before the first program, compute programs included
+	Shader phongShader("assets/PhongShader.vert", "assets/Surface.frag", kPhongFeatures);
+	Shader basicShader("assets/BasicShader.vert", "assets/BasicShader.frag", 0);
+	Shader proceduralShader("assets/ProceduralShader.vert", "assets/Surface.frag", kPhongFeatures); // phong lit, vertices from gl_VertexID
+	Shader batchedShader("assets/BatchedShader.vert", "assets/Surface.frag", kPhongFeatures | SHADER_MULTI_DRAW); // phong lit, object data indexed by gl_DrawID
+	Shader gpuDrivenShader("assets/GpuDrivenShader.vert", "assets/Surface.frag", kPhongFeatures | SHADER_MULTI_DRAW); // phong lit, object index from the visible list of the cull pass
+	std::vector<Shader> passShaders; // variants of the enabled passes only, a disabled pass costs no compile
+	passShaders.reserve(11); // the lit shaders point into it
+	if (depthPrepass) { // depth pre-pass variants, the vertex shaders declare gl_Position invariant
+		passShaders.push_back(Shader("assets/PhongShader.vert", "assets/Surface.frag", SHADER_DEPTH_ONLY));
+		phongShader.depthShader = &passShaders.back();
+		passShaders.push_back(Shader("assets/ProceduralShader.vert", "assets/Surface.frag", SHADER_DEPTH_ONLY));
+		proceduralShader.depthShader = &passShaders.back();
+		passShaders.push_back(Shader("assets/BatchedShader.vert", "assets/Surface.frag", SHADER_DEPTH_ONLY));
+		batchedShader.depthShader = &passShaders.back();
+		passShaders.push_back(Shader("assets/GpuDrivenShader.vert", "assets/Surface.frag", SHADER_DEPTH_ONLY));
+		gpuDrivenShader.depthShader = &passShaders.back();
+	}
+	const Shader* deferredDirectionalShader = nullptr; // deferred lighting
+	const Shader* deferredPointShader = nullptr;
+	const Shader* deferredCompositeShader = nullptr;
+	if (deferredShading) { // deferred geometry pass variants and the lighting programs
+		passShaders.push_back(Shader("assets/PhongShader.vert", "assets/Surface.frag", SHADER_GBUFFER | SHADER_TEXTURED));
+		phongShader.gbufferShader = &passShaders.back();
+		passShaders.push_back(Shader("assets/ProceduralShader.vert", "assets/Surface.frag", SHADER_GBUFFER | SHADER_TEXTURED));
+		proceduralShader.gbufferShader = &passShaders.back();
+		passShaders.push_back(Shader("assets/BatchedShader.vert", "assets/Surface.frag", SHADER_GBUFFER | SHADER_TEXTURED | SHADER_MULTI_DRAW));
+		batchedShader.gbufferShader = &passShaders.back();
+		passShaders.push_back(Shader("assets/GpuDrivenShader.vert", "assets/Surface.frag", SHADER_GBUFFER | SHADER_TEXTURED | SHADER_MULTI_DRAW));
+		gpuDrivenShader.gbufferShader = &passShaders.back();
+		passShaders.push_back(Shader("assets/DeferredFullscreen.vert", "assets/DeferredDirectional.frag", 0));
+		deferredDirectionalShader = &passShaders.back();
+		passShaders.push_back(Shader("assets/DeferredPointLight.vert", "assets/DeferredPointLight.frag", 0));
+		deferredPointShader = &passShaders.back();
+		passShaders.push_back(Shader("assets/DeferredFullscreen.vert", "assets/DeferredComposite.frag", 0));
+		deferredCompositeShader = &passShaders.back();
+	}
+	Shader pyramidDebugShader("assets/PyramidDebug.vert", "assets/PyramidDebug.frag", 0); // one level of the depth pyramid over the frame
+	Shader& primitiveShader = proceduralMeshes ? proceduralShader : phongShader; // shader for spheres and cylinders
 
 	// instantiate objects
+	SetTextureArrayMode(textureArrays); // textures of the objects below go into arrays by size and format
 
 	// cuboid definition generation
 	Cuboid cuboid(
@@ -309,7 +325,8 @@ int main(int argc, char** argv)
 		0.1f, // ka 
 		0.7f, // kd
 		0.1f, // ks
-		2 // alpha
+		2, // alpha
+		packedVertices // packed vertex format
 	);
 
 	Cylinder cylinder(
@@ -324,8 +341,15 @@ int main(int argc, char** argv)
 		0.7f, // kd
 		0.3f, // ks
 		glm::vec3(1.5f, 1.0f, 0.0f), //starting position
-		8 // alpha
+		8, // alpha
+		true, // indexed mesh
+		packedVertices, // packed vertex format
+		false, // no CPU copy
+		lodLevels, // LOD levels
+		proceduralMeshes // no vertex buffer, built in ProceduralShader.vert
 	);
+	cylinder.lod.edgePixels = lodEdgePixels;
+	cylinder.lod.hysteresis = lodHysteresis;
 
 
 	Sphere sphere(
@@ -340,8 +364,15 @@ int main(int argc, char** argv)
 		glm::vec3(-1.5f, 1.0f, 0.0f), //starting position
 		32, // latitude segments
 		64, // longitude segments
-		8 // alpha
+		8, // alpha
+		true, // indexed mesh
+		packedVertices, // packed vertex format
+		false, // no CPU copy
+		lodLevels, // LOD levels
+		proceduralMeshes // no vertex buffer, built in ProceduralShader.vert
 	);
+	sphere.lod.edgePixels = lodEdgePixels;
+	sphere.lod.hysteresis = lodHysteresis;
 
 
 	//generate camera
@@ -370,13 +401,45 @@ int main(int argc, char** argv)
 	pointLightSource.transform = glm::translate(pointLightSource.transform, pointLightSource.position);
 	pointLightSource.transform = glm::scale(pointLightSource.transform, glm::vec3(1.0f, 1.0f, 1.0f));
 
+	ClusteredLights pointLights(1 + std::max(scatteredLights, 0), width, height); // every point light, binned into froxels each frame
+	unsigned int movableLight = pointLights.Add(pointLightSource.position, pointLightSource.color, pointLightSource.attenuation_Constant, pointLightSource.attenuation_Linear, pointLightSource.attenuation_Quadratic);
+	std::mt19937 lightRandom(2020); // the same lights every run
+	std::uniform_real_distribution<float> lightSpread(-4.0f, 4.0f);
+	std::uniform_real_distribution<float> lightTint(0.1f, 0.5f);
+	for (int i = 0; i < scatteredLights; i++) {
+		pointLights.Add(
+			glm::vec3(lightSpread(lightRandom), 0.75f * lightSpread(lightRandom), lightSpread(lightRandom)), // position
+			glm::vec3(lightTint(lightRandom), lightTint(lightRandom), lightTint(lightRandom)), // color
+			1.0f, // constant attenuation
+			2.0f, // linear attenuation
+			30.0f // quadratic attenuation, a range of about 2
+		);
+	}
+
 	DirectionalLightSource directionalLightSource(
 		glm::mat4(1.0f), //transform
 		glm::vec3(0.8f, 0.8f, 0.8f), //color
 		glm::vec3(0.0f, -1.0f, -1.0f) //direction
 	);
 
-	glEnable(GL_DEPTH_TEST); // enable Z-Depth buffer system
+	CachedSetCapability(GL_DEPTH_TEST, true); // enable Z-Depth buffer system
+
+	RenderQueue renderQueue((float)zFar); // draw packets of the frame, depth keys span up to the far plane
+	StreamRingBuffer frameStream((GLsizeiptr)streamSegmentKb * 1024); // per frame uniforms and object data, kStreamSegments frames in flight
+	FrameUniformBuffer frameUniforms(&frameStream); // camera and light data of the frame, bound to the FrameData block of every program
+	MultiDrawBatch sceneBatch(&frameStream); // every buffered mesh in one shared VBO/EBO, drawn with one indirect call per texture
+	FrustumCuller sceneCuller; // world space bounds of every object, tested against the frustum each frame
+	TransformBatch sceneTransforms; // MVP and normal matrix of every submitted object, computed once per frame
+	GpuSceneCuller gpuScene(sceneBatch); // objects registered once, culled and LOD selected on the GPU
+	DepthPyramid depthPyramid(width, height); // last frame's depth as a max mip chain, for occlusion culling
+	StateCacheCounters stateCalls = { 0, 0 }; // issued/skipped cached state calls of the last complete frame
+	SamplesPassedQuery shadedSamples; // samples of the shading pass that passed the depth test, with and without pre-pass
+	GBuffer gBuffer(width, height, ParseGBufferFormat(gbufferNormals, gbufferDepth)); // surface data of the deferred path
+	if (gpuCulling) {
+		gpuScene.Add(cuboid.MakeDrawPacket(), cuboid.bounds);
+		gpuScene.Add(cylinder.MakeDrawPacket(), cylinder.bounds, &cylinder.lod);
+		gpuScene.Add(sphere.MakeDrawPacket(), sphere.bounds, &sphere.lod);
+	}
 
 	// render loop
 	while (!glfwWindowShouldClose(window)) // render loop
@@ -481,6 +544,9 @@ int main(int argc, char** argv)
 			); // after being set in the right cartesian position, finally look at the target
 
 		// handle pixel drawing
+			stateCalls = GetStateCacheCounters(); // the previous frame is complete here
+			ResetStateCacheCounters(); // issued/skipped state calls are counted per frame
+			frameStream.BeginFrame(); // next ring segment, frameStream.fenceWaits counts the frames this had to wait for the GPU
 			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT); // clear screen with default color
 
 			GLenum mode;
@@ -490,39 +556,152 @@ int main(int argc, char** argv)
 			else {
 				mode = GL_FILL;
 			}
-			if (backFaceCullingMode) {
-				glEnable(GL_CULL_FACE);
+			CachedSetCapability(GL_CULL_FACE, backFaceCullingMode); // only reaches the driver when toggled
+			CachedPolygonMode(mode);
+
+			CachedFrontFace(GL_CCW);		// counter clockwise
+
+			if (movableLight != kInvalidLight) {
+				pointLights.Move(movableLight, pointLightSource.position);
+			}
+			if (deferredShading) {
+				pointLights.Upload(); // drawn as volumes, no froxel lists needed
 			}
 			else {
-				glDisable(GL_CULL_FACE);
+				pointLights.Bin(viewMatrix, mainCamera.projectionMatrix); // light lists of the froxels, read by the phong fragment shaders
+			}
+			frameUniforms.Update(viewMatrix, mainCamera, pointLights, directionalLightSource); // one upload for every program and draw of the frame
+
+			// RenderPointLightSource(pointLightSource, basicShader);
+			renderQueue.Clear();
+			sceneBatch.Clear();
+			sceneCuller.Clear();
+			sceneTransforms.Clear();
+			if (gpuCulling) {
+				gpuScene.Cull(height, hizOcclusion ? &depthPyramid : nullptr); // culling and LOD selection of every registered object in one dispatch
+			}
+			else {
+				cylinder.UpdateLod(mainCamera.projectionMatrix, mainCamera.cameraPosition, height); // pick tessellation from the on-screen size
+				sphere.UpdateLod(mainCamera.projectionMatrix, mainCamera.cameraPosition, height);
+
+				unsigned int cuboidBounds = sceneCuller.Add(cuboid.WorldBounds()); // transforms may change every frame
+				unsigned int cylinderBounds = sceneCuller.Add(cylinder.WorldBounds());
+				unsigned int sphereBounds = sceneCuller.Add(sphere.WorldBounds());
+				if (frustumCulling) {
+					sceneCuller.Cull(mainCamera.projectionMatrix * viewMatrix);
+				}
+				if (!frustumCulling || sceneCuller.Visible(cuboidBounds)) {
+					SubmitDrawPacket(cuboid.MakeDrawPacket(), phongShader, renderQueue, sceneBatch, sceneTransforms, multiDraw, mainCamera.cameraPosition);
+				}
+				if (!frustumCulling || sceneCuller.Visible(cylinderBounds)) {
+					SubmitDrawPacket(cylinder.MakeDrawPacket(), primitiveShader, renderQueue, sceneBatch, sceneTransforms, multiDraw, mainCamera.cameraPosition);
+				}
+				if (!frustumCulling || sceneCuller.Visible(sphereBounds)) {
+					SubmitDrawPacket(sphere.MakeDrawPacket(), primitiveShader, renderQueue, sceneBatch, sceneTransforms, multiDraw, mainCamera.cameraPosition);
+				}
+			}
+			sceneTransforms.Compute(mainCamera.projectionMatrix * viewMatrix); // every submitted object in one SIMD pass, the shaders only multiply the vertex
+			renderQueue.Sort(); // group by program, texture and VAO, front to back inside a group
+			if (multiDraw) {
+				sceneBatch.Prepare(sceneTransforms); // commands and object data once, drawn by both passes
 			}
-			glPolygonMode(GL_FRONT_AND_BACK, mode);
 
-			glFrontFace(GL_CCW);		// counter clockwise
+			// every opaque path with the programs of "pass", the depth pass binds no textures
+			auto drawOpaque = [&](RenderPass pass) {
+				bool depthOnly = pass == PASS_DEPTH;
+				ExecuteRenderQueue(renderQueue, sceneTransforms, pass); // procedural primitives, or everything without multi-draw
+				if (multiDraw) {
+					const Shader& shader = PassShader(batchedShader, pass);
+					CachedUseProgram(shader.program);
+					if (!depthOnly) {
+						glUniform1i(shader.textureLocation, 0); // diffuse texture on unit 0
+						glUniform1i(shader.textureArrayLocation, 1); // diffuse texture array on unit 1
+					}
+					sceneBatch.Draw(shader.drawOffset, !depthOnly);
+				}
+				if (gpuCulling) {
+					const Shader& shader = PassShader(gpuDrivenShader, pass);
+					CachedUseProgram(shader.program);
+					if (!depthOnly) {
+						glUniform1i(shader.textureLocation, 0); // diffuse texture on unit 0
+						glUniform1i(shader.textureArrayLocation, 1); // diffuse texture array on unit 1
+					}
+					gpuScene.Draw(!depthOnly);
+				}
+			};
 
-			// RenderPointLightSource(pointLightSource, basicShader, viewMatrix, mainCamera);
-			RenderCuboid(cuboid, phongShader, viewMatrix, mainCamera, pointLightSource, directionalLightSource);
-			RenderCylinder(cylinder, phongShader, viewMatrix, mainCamera, pointLightSource, directionalLightSource);
-			RenderSphere(sphere, phongShader, viewMatrix, mainCamera, pointLightSource, directionalLightSource);
+			if (deferredShading) {
+				gBuffer.BeginGeometry(); // the opaque passes below fill the G-buffer
+			}
+			if (depthPrepass) {
+				CachedColorMask(false);
+				drawOpaque(PASS_DEPTH);
+				CachedColorMask(true);
+				CachedDepthFunc(GL_EQUAL); // only the fragment that won the pre-pass runs the Phong shader
+				CachedDepthMask(false); // already written
+			}
+			shadedSamples.Begin();
+			drawOpaque(deferredShading ? PASS_GBUFFER : PASS_SHADED);
+			shadedSamples.End();
+			if (depthPrepass) {
+				CachedDepthFunc(GL_LESS);
+				CachedDepthMask(true); // glClear of the next frame only clears depth with writes on
+			}
+			if (deferredShading) {
+				gBuffer.Light(deferredDirectionalShader->program, deferredPointShader->program, pointLights.Count(), mainCamera.projectionMatrix * viewMatrix); // cost per lit pixel
+				gBuffer.Composite(deferredCompositeShader->program); // back to the default framebuffer, with depth for the pyramid
+			}
+			if (hizOcclusion || depthPyramidDebugLevel >= 0) {
+				depthPyramid.Build(mainCamera.projectionMatrix * viewMatrix); // the back buffer is undefined after the swap, so this frame's depth is reduced now
+			}
+			if (depthPyramidDebugLevel >= depthPyramid.levels) {
+				depthPyramidDebugLevel = -1; // F3 cycled past the last level
+			}
+			if (depthPyramidDebugLevel >= 0) {
+				depthPyramid.DrawDebug(pyramidDebugShader.program, depthPyramidDebugLevel);
+			}
+			frameStream.EndFrame(); // fence after the last draw reading this frame's segment
+
+			if (time - statsTime >= 1.0) { // frame stats in the title, once a second so the title bar does not flicker
+				statsTime = time;
+				unsigned int culledObjects = gpuCulling ? gpuScene.culled : sceneCuller.culled;
+				unsigned int testedObjects = gpuCulling ? gpuScene.culled + gpuScene.visible : sceneCuller.tested;
+				std::string stats = window_title
+					+ " | culled " + std::to_string(culledObjects) + "/" + std::to_string(testedObjects) + (gpuCulling ? " (GPU)" : "")
+					+ (hizOcclusion ? " | occluded " + std::to_string(gpuScene.occluded) : "")
+					+ " | lights " + std::to_string(pointLights.Count()) + (deferredShading ? " (deferred)" : " (clustered)")
+					+ " | variants " + std::to_string(ShaderVariantCount()) + " (" + std::to_string(ProgramCacheHits()) + " cached)"
+					+ " | shaded samples " + std::to_string(shadedSamples.samples) + (depthPrepass ? " (pre-pass)" : "")
+					+ " | fence waits " + std::to_string(frameStream.fenceWaits)
+					+ " | state calls " + std::to_string(stateCalls.issued) + " issued/" + std::to_string(stateCalls.skipped) + " skipped";
+				glfwSetWindowTitle(window, stats.c_str());
+			}
 
 			glfwSwapBuffers(window); // swap buffer
 		}
 	}
 
 	/* Free Resources */
-	glUseProgram(0);
-	glBindVertexArray(0);
-	glDeleteProgram(phongShader.program);
-	glDeleteProgram(gouradShader.program);
-
-	glDeleteProgram(basicShader.program);
-
-	glDeleteBuffers(1, &cuboid.Vbo);
-	glDeleteBuffers(1, &cuboid.Ebo);
-	glDeleteVertexArrays(1, &cuboid.Vao);
+	CachedUseProgram(0);
+	CachedBindVertexArray(0);
+	ReleaseShaderPrograms(); // every variant, programs are shared between Shader objects
+
+	ReleaseGeometry(cuboid.geometry); // deletes the VAO/VBO with the last user
+	sphere.lod.Release(); // every LOD level holds a reference
+	cylinder.lod.Release();
+	ReleaseProceduralResources();
+	frameUniforms.Release();
+	gpuScene.Release();
+	depthPyramid.Release();
+	shadedSamples.Release();
+	pointLights.Release();
+	gBuffer.Release();
+	sceneBatch.Release();
+	frameStream.Release();
+	ReleaseTextureArrays();
 
 	glDeleteBuffers(1, &pointLightSource.Vbo);
-	glDeleteVertexArrays(1, &pointLightSource.Vao);
+	CachedDeleteVertexArray(pointLightSource.Vao);
 
 
 	destroyFramework(); // destroy framework
@@ -608,6 +787,9 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
 	if (key == GLFW_KEY_F2 && action == GLFW_PRESS) {
 		backFaceCullingMode = !backFaceCullingMode;
 	}
+	if (key == GLFW_KEY_F3 && action == GLFW_PRESS) {
+		depthPyramidDebugLevel++; // next pyramid level, wraps to off after the last one
+	}
 	if (key == GLFW_KEY_W && action == GLFW_PRESS) {
 		Input.W_KEY_PRESSED = TRUE;
 	}
@@ -666,160 +848,123 @@ double DegreesToRadians(double degrees) {
 	return (degrees * PI) / 180;
 }
 
-void RenderCuboid(Cuboid object, Shader shader, glm::mat4 viewMatrix, OrbitalCamera camera, PointLightSource pLightSource, DirectionalLightSource dLightSource) {
-	/////DRAW cuboid1 with phong shader
-	glUseProgram(shader.program); // Load the shader into the rendering pipeline 
-
-	glUniformMatrix4fv(shader.view, 1, GL_FALSE, glm::value_ptr(viewMatrix)); // push view matrix to shader
-	glUniformMatrix4fv(shader.proj, 1, GL_FALSE, glm::value_ptr(camera.projectionMatrix)); // push projection matrix to shader
-	glUniformMatrix4fv(shader.model, 1, GL_FALSE, glm::value_ptr(glm::mat4(1.0f))); // push default model matrix to shader
-
-	glUniform3f(shader.viewPosition, camera.cameraPosition.x, camera.cameraPosition.y, camera.cameraPosition.z); // push color to shader
-
-	glBindVertexArray(object.Vao); //  bind cuboid VAO
-
-	glUniformMatrix4fv(shader.model, 1, GL_FALSE, glm::value_ptr(object.transform)); // push cuboid transform to shader
-	glUniform3f(shader.materialColor, object.material.baseColor.r, object.material.baseColor.g, object.material.baseColor.b); // push color to shader
-
-	glUniform1f(shader.k_constant, pLightSource.attenuation_Constant);
-	glUniform1f(shader.k_linear, pLightSource.attenuation_Linear);
-	glUniform1f(shader.k_quadratic, pLightSource.attenuation_Quadratic);
-
-	glUniform1i(shader.alpha, object.material.alpha);
-
-	glm::vec3 energy = glm::vec3(pLightSource.color.x, pLightSource.color.y, pLightSource.color.z);
-
-	glUniform3f(shader.pointLightColor, energy.x, energy.y, energy.z); // push color to shader
-	glUniform3f(shader.pointLightPosition, pLightSource.position.x, pLightSource.position.y, pLightSource.position.z); // push color to shader
-
-	glUniform3f(shader.directionalLightColor, dLightSource.color.x, dLightSource.color.y, dLightSource.color.z); // push color to shader
-	glUniform3f(shader.directionalLightDirection, dLightSource.direction.x, dLightSource.direction.y, dLightSource.direction.z); // push color to shader
-
-	glUniform1f(shader.k_ambient, object.material.k_ambient);
-	glUniform1f(shader.k_diffuse, object.material.k_diffuse);
-	glUniform1f(shader.k_specular, object.material.k_specular);
-
-	if (shader.type == "phong") {
-		int unit = 0;
-		glUniform1i(shader.textureLocation, unit);
-		glActiveTexture(GL_TEXTURE0 + unit);
-		glBindTexture(GL_TEXTURE_2D, object.texture.handle);
+// the first parameter "packet" specifies the draw, the second one the program it is drawn with outside the batch
+// packets with a vertex buffer go to "batch" when "multiDraw" is set, everything else to "queue", either way the transform goes to "transforms"
+void SubmitDrawPacket(DrawPacket packet, const Shader& shader, RenderQueue& queue, MultiDrawBatch& batch, TransformBatch& transforms, bool multiDraw, glm::vec3 cameraPosition) {
+	packet.transformIndex = transforms.Add(*packet.transform);
+	if (multiDraw && packet.geometry != nullptr) {
+		batch.Add(packet);
+	}
+	else {
+		queue.Submit(packet, &shader, shader.program, cameraPosition);
 	}
-
-
-	glDrawArrays(GL_TRIANGLES, 0, 36);
-	glBindVertexArray(0); // unbind VAO
 }
 
-void RenderSphere(Sphere object, Shader shader, glm::mat4 viewMatrix, OrbitalCamera camera, PointLightSource pLightSource, DirectionalLightSource dLightSource) {
-	/////DRAW cylinder1 with phong shader
-
-	glUseProgram(shader.program); // Load the shader into the rendering pipeline 
-
-	glUniformMatrix4fv(shader.view, 1, GL_FALSE, glm::value_ptr(viewMatrix)); // push view matrix to shader
-	glUniformMatrix4fv(shader.proj, 1, GL_FALSE, glm::value_ptr(camera.projectionMatrix)); // push projection matrix to shader
-	glUniformMatrix4fv(shader.model, 1, GL_FALSE, glm::value_ptr(glm::mat4(1.0f))); // push default model matrix to shader
-
-	glUniform3f(shader.viewPosition, camera.cameraPosition.x, camera.cameraPosition.y, camera.cameraPosition.z); // push color to shader
-
-	glBindVertexArray(object.Vao); //  bind cuboid VAO
-
-	glUniformMatrix4fv(shader.model, 1, GL_FALSE, glm::value_ptr(object.transform)); // push cuboid transform to shader
-	glUniform3f(shader.materialColor, object.material.baseColor.r, object.material.baseColor.g, object.material.baseColor.b); // push color to shader
-
-	glUniform1f(shader.k_constant, pLightSource.attenuation_Constant);
-	glUniform1f(shader.k_linear, pLightSource.attenuation_Linear);
-	glUniform1f(shader.k_quadratic, pLightSource.attenuation_Quadratic);
-
-	glUniform1i(shader.alpha, object.material.alpha);
-
-	glm::vec3 energy = glm::vec3(pLightSource.color.x, pLightSource.color.y, pLightSource.color.z);
-
-	glUniform3f(shader.pointLightColor, energy.x, energy.y, energy.z); // push color to shader
-	glUniform3f(shader.pointLightPosition, pLightSource.position.x, pLightSource.position.y, pLightSource.position.z); // push color to shader
-
-	glUniform3f(shader.directionalLightColor, dLightSource.color.x, dLightSource.color.y, dLightSource.color.z); // push color to shader
-	glUniform3f(shader.directionalLightDirection, dLightSource.direction.x, dLightSource.direction.y, dLightSource.direction.z); // push color to shader
-
-	glUniform1f(shader.k_ambient, object.material.k_ambient);
-	glUniform1f(shader.k_diffuse, object.material.k_diffuse);
-	glUniform1f(shader.k_specular, object.material.k_specular);
-
-	if (shader.type == "phong") {
-		int unit = 0;
-		glUniform1i(shader.textureLocation, unit);
-		glActiveTexture(GL_TEXTURE0 + unit);
-		glBindTexture(GL_TEXTURE_2D, object.texture.handle);
+// the program of "shader" that draws "pass", shaders without a variant for the pass draw it themselves
+const Shader& PassShader(const Shader& shader, RenderPass pass) {
+	if (pass == PASS_DEPTH && shader.depthShader != nullptr) {
+		return *shader.depthShader;
 	}
-
-
-	glDrawArrays(GL_TRIANGLES, 0, object.mesh.data.size());
-	glBindVertexArray(0); // unbind VAO
-
+	if (pass == PASS_GBUFFER && shader.gbufferShader != nullptr) {
+		return *shader.gbufferShader;
+	}
+	return shader;
 }
 
-void RenderCylinder(Cylinder object, Shader shader, glm::mat4 viewMatrix, OrbitalCamera camera, PointLightSource pLightSource, DirectionalLightSource dLightSource) {
-	/////DRAW cylinder1 with phong shader
-	glUseProgram(shader.program); // Load the shader into the rendering pipeline 
-
-	glUniformMatrix4fv(shader.view, 1, GL_FALSE, glm::value_ptr(viewMatrix)); // push view matrix to shader
-	glUniformMatrix4fv(shader.proj, 1, GL_FALSE, glm::value_ptr(camera.projectionMatrix)); // push projection matrix to shader
-	glUniformMatrix4fv(shader.model, 1, GL_FALSE, glm::value_ptr(glm::mat4(1.0f))); // push default model matrix to shader
-
-	glUniform3f(shader.viewPosition, camera.cameraPosition.x, camera.cameraPosition.y, camera.cameraPosition.z); // push color to shader
-
-	glBindVertexArray(object.Vao); //  bind cuboid VAO
-
-	glUniformMatrix4fv(shader.model, 1, GL_FALSE, glm::value_ptr(object.transform)); // push cuboid transform to shader
-	glUniform3f(shader.materialColor, object.material.baseColor.r, object.material.baseColor.g, object.material.baseColor.b); // push color to shader
-
-	glUniform1f(shader.k_constant, pLightSource.attenuation_Constant);
-	glUniform1f(shader.k_linear, pLightSource.attenuation_Linear);
-	glUniform1f(shader.k_quadratic, pLightSource.attenuation_Quadratic);
-
-	glUniform1i(shader.alpha, object.material.alpha);
+// the parameter "queue" specifies the sorted packets to draw, camera and lights come from the FrameData uniform buffer
+// decode and material uniforms are only pushed when they differ from the previous packet, program, texture and VAO go through the state cache.
+// "pass" picks the program variant of each shader, the depth pass skips textures, materials and normal matrices.
+// MVP and normal matrix of each packet come from "transforms", computed after the last packet was submitted
+void ExecuteRenderQueue(const RenderQueue& queue, const TransformBatch& transforms, RenderPass pass) {
+	bool depthOnly = pass == PASS_DEPTH;
+	const Shader* currentShader = nullptr;
+	const Geometry* currentGeometry = nullptr;
+	const Material* currentMaterial = nullptr;
+
+	for (size_t i = 0; i < queue.order.size(); i++) {
+		const DrawPacket& packet = queue.packets[queue.order[i].packet];
+		const Shader& shader = PassShader(*packet.shader, pass);
+
+		if (&shader != currentShader) { // per object uniforms live in the program, so they have to be pushed again
+			CachedUseProgram(shader.program); // Load the shader into the rendering pipeline 
+			if (shader.features & SHADER_TEXTURED) {
+				glUniform1i(shader.textureLocation, 0); // diffuse texture on unit 0
+				glUniform1i(shader.textureArrayLocation, 1); // diffuse texture array on unit 1
+			}
+			currentShader = &shader;
+			currentGeometry = nullptr;
+			currentMaterial = nullptr;
+		}
 
-	glm::vec3 energy = glm::vec3(pLightSource.color.x, pLightSource.color.y, pLightSource.color.z);
+		if (shader.features & SHADER_TEXTURED) {
+			CachedBindTexture(packet.textureTarget == GL_TEXTURE_2D_ARRAY ? 1 : 0, packet.textureTarget, packet.texture);
+		}
 
-	glUniform3f(shader.pointLightColor, energy.x, energy.y, energy.z); // push color to shader
-	glUniform3f(shader.pointLightPosition, pLightSource.position.x, pLightSource.position.y, pLightSource.position.z); // push color to shader
+		if (!depthOnly && packet.material != currentMaterial) {
+			const Material& material = *packet.material;
+			glUniform3f(shader.materialColor, material.baseColor.r, material.baseColor.g, material.baseColor.b); // push color to shader
+			glUniform1f(shader.k_ambient, material.k_ambient);
+			glUniform1f(shader.k_diffuse, material.k_diffuse);
+			glUniform1f(shader.k_specular, material.k_specular);
+			glUniform1i(shader.alpha, material.alpha);
+			glUniform2f(shader.textureScale, material.textureScale.x, material.textureScale.y); // push uv repeat to shader
+			glUniform1i(shader.textureLayer, material.textureLayer); // push texture array layer to shader
+			currentMaterial = packet.material;
+		}
 
-	glUniform3f(shader.directionalLightColor, dLightSource.color.x, dLightSource.color.y, dLightSource.color.z); // push color to shader
-	glUniform3f(shader.directionalLightDirection, dLightSource.direction.x, dLightSource.direction.y, dLightSource.direction.z); // push color to shader
+		const ObjectTransform& transform = transforms.transforms[packet.transformIndex];
+		glUniformMatrix4fv(shader.model, 1, GL_FALSE, glm::value_ptr(*packet.transform)); // push object transform to shader
+		glUniformMatrix4fv(shader.mvp, 1, GL_FALSE, glm::value_ptr(transform.mvp)); // push model view projection to shader
+		if (!depthOnly) {
+			glm::mat3 normalMatrix = glm::mat3(glm::vec3(transform.normalMatrix[0]), glm::vec3(transform.normalMatrix[1]), glm::vec3(transform.normalMatrix[2])); // the transform scales non-uniformly, normals need the inverse transpose
+			glUniformMatrix3fv(shader.normalMatrix, 1, GL_FALSE, glm::value_ptr(normalMatrix)); // push normal matrix to shader
+		}
 
-	glUniform1f(shader.k_ambient, object.material.k_ambient);
-	glUniform1f(shader.k_diffuse, object.material.k_diffuse);
-	glUniform1f(shader.k_specular, object.material.k_specular);
+		if (packet.geometry == nullptr) { // procedural, ProceduralShader.vert builds the vertices of the active LOD level
+			glUniform1i(shader.primitiveType, packet.primitive);
+			glUniform2i(shader.primitiveSegments, packet.segments[0], packet.segments[1]);
+			DrawProcedural(packet.primitive, packet.segments[0], packet.segments[1]);
+			continue;
+		}
 
+		CachedBindVertexArray(packet.geometry->Vao); //  bind the shared VAO
+		if (packet.geometry != currentGeometry) {
+			PushVertexQuantization(shader, packet.geometry->quantization); // push vertex decode parameters to shader
+			currentGeometry = packet.geometry;
+		}
 
-	if (shader.type == "phong") {
-		int unit = 0;
-		glUniform1i(shader.textureLocation, unit);
-		glActiveTexture(GL_TEXTURE0 + unit);
-		glBindTexture(GL_TEXTURE_2D, object.texture.handle);
+		if (packet.geometry->indexed) {
+			glDrawElements(GL_TRIANGLES, packet.geometry->elementCount, packet.geometry->indexType, 0);
+		}
+		else {
+			glDrawArrays(GL_TRIANGLES, 0, packet.geometry->elementCount);
+		}
 	}
-
-
-	glDrawArrays(GL_TRIANGLES, 0, object.mesh.data.size());
-	glBindVertexArray(0); // unbind VAO
 }
 
-void RenderPointLightSource(PointLightSource pLightSource, Shader shader, glm::mat4 viewMatrix, OrbitalCamera camera) {
-	//////// draw light source with basic shader
-	glUseProgram(shader.program); // Load the shader into the rendering pipeline 
+void RenderPointLightSource(PointLightSource pLightSource, Shader shader) {
+	//////// draw light source with basic shader, view and projection come from the FrameData uniform buffer
+	CachedUseProgram(shader.program); // Load the shader into the rendering pipeline 
 
-	glUniformMatrix4fv(shader.view, 1, GL_FALSE, glm::value_ptr(viewMatrix)); // push view matrix to shader
-	glUniformMatrix4fv(shader.proj, 1, GL_FALSE, glm::value_ptr(camera.projectionMatrix)); // push projection matrix to shader
 	glUniformMatrix4fv(shader.model, 1, GL_FALSE, glm::value_ptr(glm::mat4(1.0f))); // push default model matrix to shader
 
-	glBindVertexArray(pLightSource.Vao);
+	CachedBindVertexArray(pLightSource.Vao);
 	glUniformMatrix4fv(shader.model, 1, GL_FALSE, glm::value_ptr(pLightSource.transform)); // push cylinder transform to shader
 	glUniform4f(shader.pointLightColor, pLightSource.color.x, pLightSource.color.y, pLightSource.color.z, 1.0); // push color to shader
 	glDrawArrays(GL_TRIANGLES, 0, 36);
-	glBindVertexArray(0); // unbind VAO
 	/////
 }
 
+// the first parameter "shader" specifies the shader whose decode uniforms are set
+// the second parameter "quantization" specifies how the bound vertex buffer has to be decoded
+void PushVertexQuantization(const Shader& shader, const VertexQuantization& quantization) {
+	glUniform3f(shader.positionOffset, quantization.positionOffset.x, quantization.positionOffset.y, quantization.positionOffset.z);
+	glUniform3f(shader.positionScale, quantization.positionScale.x, quantization.positionScale.y, quantization.positionScale.z);
+	glUniform2f(shader.uvOffset, quantization.uvOffset.x, quantization.uvOffset.y);
+	glUniform2f(shader.uvScale, quantization.uvScale.x, quantization.uvScale.y);
+	glUniform1i(shader.octahedralNormals, quantization.packed);
+}
+
 static std::string FormatDebugOutput(GLenum source, GLenum type, GLuint id, GLenum severity, const char* msg) {
 	std::stringstream stringStream;
 	std::string sourceString;
@@ -2,6 +2,8 @@
 #include "Material.h"
 
 Material::Material() {
+	textureScale = glm::vec2(1.0f, 1.0f);
+	textureLayer = -1;
 
 }
 
@@ -13,6 +15,8 @@ Material::Material(float r, float g, float b, float ka, float kd, float ks, int
 	k_diffuse = kd;
 	k_specular = ks;
 	alpha = a;
+	textureScale = glm::vec2(1.0f, 1.0f);
+	textureLayer = -1;
 }
 
 Material::~Material() {
@@ -13,6 +13,8 @@ public:
 	float k_diffuse;
 	float k_specular;
 	int alpha;
+	glm::vec2 textureScale; // uv repeat of the texture, (1, 1) stretches it once over the mesh uvs
+	int textureLayer; // layer of the texture array the texture lives in, -1 for a plain GL_TEXTURE_2D
 	Material();
 	Material(float, float, float, float, float, float, int);
 	Material::~Material();
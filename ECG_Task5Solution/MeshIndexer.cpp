@@ -0,0 +1,50 @@
+#include "MeshIndexer.h"
+#include <unordered_map>
+#include <cstring>
+
+// FNV-1a hash over the raw bytes of one vertex
+static size_t HashVertex(const float* vertex, int stride) {
+	const unsigned char* bytes = reinterpret_cast<const unsigned char*>(vertex);
+	size_t hash = 2166136261u;
+	for (size_t i = 0; i < stride * sizeof(float); i++) {
+		hash ^= bytes[i];
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+void IndexVertices(const std::vector<float>& data, int stride, std::vector<float>& vertices, std::vector<unsigned int>& indices) {
+	size_t vertexCount = data.size() / stride; // vertices in the triangle list
+
+	vertices.clear();
+	indices.clear();
+	indices.reserve(vertexCount);
+
+	std::unordered_multimap<size_t, unsigned int> lookup; // vertex hash -> unique vertex index
+	lookup.reserve(vertexCount);
+
+	for (size_t i = 0; i < vertexCount; i++) {
+		const float* vertex = &data[i * stride];
+		size_t hash = HashVertex(vertex, stride);
+
+		// look for an already emitted vertex with the exact same bits
+		unsigned int index = (unsigned int)(vertices.size() / stride);
+		auto range = lookup.equal_range(hash);
+		for (auto it = range.first; it != range.second; ++it) {
+			if (std::memcmp(&vertices[it->second * stride], vertex, stride * sizeof(float)) == 0) {
+				index = it->second;
+				break;
+			}
+		}
+
+		if (index == vertices.size() / stride) { // new unique vertex
+			vertices.insert(vertices.end(), vertex, vertex + stride);
+			lookup.emplace(hash, index);
+		}
+		indices.push_back(index);
+	}
+}
+
+bool FitsShortIndices(size_t vertexCount) {
+	return vertexCount <= 65536; // indices 0..65535
+}
@@ -0,0 +1,16 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+
+#ifndef  MeshIndexer_h
+#define MeshIndexer_h
+
+// welds the bitwise identical vertices of an interleaved triangle list ("stride" floats per vertex)
+// into a unique vertex array plus a triangle index list. Vertices that only share a position but
+// differ in normal or uv (e.g. along a texture seam) stay separate.
+void IndexVertices(const std::vector<float>& data, int stride, std::vector<float>& vertices, std::vector<unsigned int>& indices);
+
+// true if every index into a mesh with "vertexCount" vertices fits into an unsigned short
+bool FitsShortIndices(size_t vertexCount);
+
+#endif /MeshIndexer_h/
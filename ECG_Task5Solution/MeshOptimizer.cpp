@@ -0,0 +1,208 @@
+#include "MeshOptimizer.h"
+#include <cmath>
+#include <algorithm>
+
+// Forsyth scoring parameters, tuned for a 32 entry LRU cache
+const int kCacheSize = 32;
+const float kCacheDecayPower = 1.5f;
+const float kLastTriangleScore = 0.75f;
+const float kValenceBoostScale = 2.0f;
+const float kValenceBoostPower = 0.5f;
+
+// score of a vertex given its position in the LRU cache (-1 if not cached) and the number of triangles still using it
+static float VertexScore(int cachePosition, unsigned int remainingTriangles) {
+	if (remainingTriangles == 0) {
+		return -1.0f; // vertex is not needed anymore
+	}
+
+	float score = 0.0f;
+	if (cachePosition >= 0) {
+		if (cachePosition < 3) {
+			score = kLastTriangleScore; // used by the last triangle, fixed score so it is not favoured over its neighbours
+		}
+		else {
+			float scale = 1.0f / (kCacheSize - 3);
+			score = std::pow(1.0f - (cachePosition - 3) * scale, kCacheDecayPower);
+		}
+	}
+
+	// boost vertices with few triangles left so they are finished off instead of lingering
+	score += kValenceBoostScale * std::pow((float)remainingTriangles, -kValenceBoostPower);
+	return score;
+}
+
+float CalculateACMR(const std::vector<unsigned int>& indices, size_t vertexCount, int cacheSize) {
+	if (indices.size() < 3) {
+		return 0.0f;
+	}
+
+	std::vector<size_t> timestamp(vertexCount, 0); // time a vertex entered the FIFO, 0 = never
+	size_t time = cacheSize + 1;
+	size_t misses = 0;
+
+	for (size_t i = 0; i < indices.size(); i++) {
+		unsigned int v = indices[i];
+		if (time - timestamp[v] > (size_t)cacheSize) { // not in the last cacheSize insertions
+			timestamp[v] = time++;
+			misses++;
+		}
+	}
+
+	return (float)misses / (indices.size() / 3);
+}
+
+void OptimizeVertexCache(std::vector<unsigned int>& indices, size_t vertexCount) {
+	size_t triangleCount = indices.size() / 3;
+	if (triangleCount == 0) {
+		return;
+	}
+
+	// vertex -> triangle adjacency, compressed into one array
+	std::vector<unsigned int> remaining(vertexCount, 0); // triangles left per vertex
+	for (size_t i = 0; i < indices.size(); i++) {
+		remaining[indices[i]]++;
+	}
+
+	std::vector<unsigned int> offsets(vertexCount + 1, 0); // start of each vertex' triangle list
+	for (size_t v = 0; v < vertexCount; v++) {
+		offsets[v + 1] = offsets[v] + remaining[v];
+	}
+
+	std::vector<unsigned int> adjacency(indices.size());
+	std::vector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+	for (size_t t = 0; t < triangleCount; t++) {
+		for (int k = 0; k < 3; k++) {
+			adjacency[fill[indices[t * 3 + k]]++] = (unsigned int)t;
+		}
+	}
+
+	// initial scores
+	std::vector<int> cachePosition(vertexCount, -1);
+	std::vector<float> vertexScore(vertexCount);
+	for (size_t v = 0; v < vertexCount; v++) {
+		vertexScore[v] = VertexScore(-1, remaining[v]);
+	}
+
+	std::vector<float> triangleScore(triangleCount);
+	std::vector<bool> emitted(triangleCount, false);
+	int bestTriangle = 0;
+	for (size_t t = 0; t < triangleCount; t++) {
+		triangleScore[t] = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+		if (triangleScore[t] > triangleScore[bestTriangle]) {
+			bestTriangle = (int)t;
+		}
+	}
+
+	std::vector<unsigned int> output;
+	output.reserve(indices.size());
+	std::vector<unsigned int> cache; // LRU cache, most recent first
+	std::vector<unsigned int> newCache;
+	size_t firstUnemitted = 0; // fallback scan position
+
+	while (bestTriangle >= 0) {
+		const unsigned int* triangle = &indices[bestTriangle * 3];
+		emitted[bestTriangle] = true;
+		output.insert(output.end(), triangle, triangle + 3);
+
+		// remove the triangle from its vertices' adjacency lists
+		for (int k = 0; k < 3; k++) {
+			unsigned int v = triangle[k];
+			unsigned int* list = &adjacency[offsets[v]];
+			for (unsigned int j = 0; j < remaining[v]; j++) {
+				if (list[j] == (unsigned int)bestTriangle) {
+					list[j] = list[remaining[v] - 1];
+					break;
+				}
+			}
+			remaining[v]--;
+		}
+
+		// push the triangle's vertices to the front of the cache
+		newCache.assign(triangle, triangle + 3);
+		for (size_t j = 0; j < cache.size(); j++) {
+			unsigned int v = cache[j];
+			if (v != triangle[0] && v != triangle[1] && v != triangle[2]) {
+				newCache.push_back(v);
+			}
+		}
+
+		// rescore every vertex that is in the cache or just fell out of it
+		for (size_t j = 0; j < newCache.size(); j++) {
+			unsigned int v = newCache[j];
+			cachePosition[v] = j < (size_t)kCacheSize ? (int)j : -1;
+
+			float score = VertexScore(cachePosition[v], remaining[v]);
+			float delta = score - vertexScore[v];
+			vertexScore[v] = score;
+
+			for (unsigned int a = 0; a < remaining[v]; a++) {
+				triangleScore[adjacency[offsets[v] + a]] += delta;
+			}
+		}
+
+		// pick the best triangle only once every delta is applied, a triangle on several cache vertices is complete then
+		bestTriangle = -1;
+		float bestScore = -1.0f;
+		for (size_t j = 0; j < newCache.size(); j++) {
+			unsigned int v = newCache[j];
+			for (unsigned int a = 0; a < remaining[v]; a++) {
+				unsigned int t = adjacency[offsets[v] + a];
+				if (triangleScore[t] > bestScore) {
+					bestScore = triangleScore[t];
+					bestTriangle = (int)t;
+				}
+			}
+		}
+		if (newCache.size() > (size_t)kCacheSize) {
+			newCache.resize(kCacheSize);
+		}
+		cache.swap(newCache);
+
+		// nothing left around the cache, continue with the next unused triangle
+		if (bestTriangle < 0) {
+			while (firstUnemitted < triangleCount && emitted[firstUnemitted]) {
+				firstUnemitted++;
+			}
+			if (firstUnemitted < triangleCount) {
+				bestTriangle = (int)firstUnemitted;
+			}
+		}
+	}
+
+	indices.swap(output);
+}
+
+void OptimizeVertexFetch(std::vector<float>& vertices, int stride, std::vector<unsigned int>& indices) {
+	size_t vertexCount = vertices.size() / stride;
+	const unsigned int unused = 0xffffffffu;
+	std::vector<unsigned int> remap(vertexCount, unused); // old index -> new index
+	std::vector<float> reordered(vertices.size());
+	unsigned int next = 0;
+
+	for (size_t i = 0; i < indices.size(); i++) {
+		unsigned int v = indices[i];
+		if (remap[v] == unused) {
+			remap[v] = next;
+			std::copy(&vertices[v * stride], &vertices[v * stride] + stride, &reordered[next * stride]);
+			next++;
+		}
+		indices[i] = remap[v];
+	}
+
+	reordered.resize(next * stride); // drop vertices no triangle refers to
+	vertices.swap(reordered);
+}
+
+MeshOptimizationStats OptimizeMesh(std::vector<float>& vertices, int stride, std::vector<unsigned int>& indices) {
+	MeshOptimizationStats stats;
+	size_t vertexCount = vertices.size() / stride;
+	stats.acmrBefore = CalculateACMR(indices, vertexCount);
+
+	OptimizeVertexCache(indices, vertexCount);
+	OptimizeVertexFetch(vertices, stride, indices);
+
+	stats.triangles = indices.size() / 3;
+	stats.vertices = vertices.size() / stride;
+	stats.acmrAfter = CalculateACMR(indices, stats.vertices);
+	return stats;
+}
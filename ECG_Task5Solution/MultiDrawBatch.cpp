@@ -0,0 +1,248 @@
+#include "MultiDrawBatch.h"
+#include <algorithm>
+#include <cstring>
+#include "VertexPacking.h"
+#include "GLStateCache.h"
+
+static_assert(sizeof(ObjectData) == 208, "ObjectData has to match the std430 layout of the shader struct");
+
+MultiDrawBatch::MultiDrawBatch(StreamRingBuffer* _stream) {
+	stream = _stream;
+	glGenVertexArrays(1, &Vao);
+	glGenBuffers(1, &Vbo);
+	glGenBuffers(1, &Ebo);
+	glGenBuffers(1, &Ibo);
+	glGenBuffers(1, &Ssbo);
+	glGenBuffers(1, &MvpSsbo);
+	drawCalls = 0;
+	commandUploads = 0;
+	geometryVersion = 0;
+	objectRange = StreamAllocation{ nullptr, 0, 0 };
+	objectRangeBuffer = 0;
+	mvpRange = StreamAllocation{ nullptr, 0, 0 };
+	mvpRangeBuffer = 0;
+	packed = false;
+	geometriesChanged = false;
+}
+
+void MultiDrawBatch::Clear() {
+	packets.clear();
+	order.clear();
+}
+
+void MultiDrawBatch::Add(const DrawPacket& packet) {
+	order.push_back((unsigned int)packets.size());
+	packets.push_back(packet);
+	AddGeometry(packet.geometry);
+}
+
+void MultiDrawBatch::AddGeometry(const Geometry* geometry) {
+	if (ranges.find(geometry) == ranges.end()) { // copied into the shared buffers on the next Draw
+		ranges[geometry] = GeometryRange();
+		geometries.push_back(geometry);
+		geometriesChanged = true;
+	}
+}
+
+bool MultiDrawBatch::UpdateGeometry() {
+	if (!geometriesChanged) {
+		return false;
+	}
+	RebuildGeometryBuffers();
+	return true;
+}
+
+const GeometryRange& MultiDrawBatch::Range(const Geometry* geometry) const {
+	return ranges.find(geometry)->second;
+}
+
+ObjectData MakeObjectData(const DrawPacket& packet, const ObjectTransform& transform) {
+	const Material& material = *packet.material;
+	const VertexQuantization& quantization = packet.geometry->quantization;
+	ObjectData object;
+	object.model = *packet.transform;
+	for (int k = 0; k < 3; k++) {
+		object.normalMatrix[k] = transform.normalMatrix[k]; // the transform scales non-uniformly, normals need the inverse transpose
+	}
+	object.materialColor = glm::vec4(material.baseColor.r, material.baseColor.g, material.baseColor.b, 1.0f);
+	object.k_ambient = material.k_ambient;
+	object.k_diffuse = material.k_diffuse;
+	object.k_specular = material.k_specular;
+	object.alpha = material.alpha;
+	object.textureScale = material.textureScale;
+	object.uvOffset = quantization.uvOffset;
+	object.uvScale = quantization.uvScale;
+	object.octahedralNormals = quantization.packed ? 1 : 0;
+	object.textureLayer = material.textureLayer;
+	object.positionOffset = glm::vec4(quantization.positionOffset, 0.0f);
+	object.positionScale = glm::vec4(quantization.positionScale, 0.0f);
+	return object;
+}
+
+void MultiDrawBatch::RebuildGeometryBuffers() {
+	packed = geometries[0]->quantization.packed;
+	GLsizeiptr stride = packed ? sizeof(PackedVertex) : 8 * sizeof(float);
+
+	std::vector<GLint> vertexBytes(geometries.size());
+	GLsizeiptr totalVertexBytes = 0;
+	for (size_t i = 0; i < geometries.size(); i++) {
+		glBindBuffer(GL_COPY_READ_BUFFER, geometries[i]->Vbo);
+		glGetBufferParameteriv(GL_COPY_READ_BUFFER, GL_BUFFER_SIZE, &vertexBytes[i]);
+		totalVertexBytes += vertexBytes[i];
+	}
+
+	CachedBindVertexArray(Vao);
+	glBindBuffer(GL_ARRAY_BUFFER, Vbo);
+	glBufferData(GL_ARRAY_BUFFER, totalVertexBytes, nullptr, GL_STATIC_DRAW);
+
+	std::vector<unsigned int> indices;
+	GLsizeiptr vertexOffset = 0;
+	for (size_t i = 0; i < geometries.size(); i++) {
+		const Geometry& geometry = *geometries[i];
+
+		glBindBuffer(GL_COPY_READ_BUFFER, geometry.Vbo);
+		glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_ARRAY_BUFFER, 0, vertexOffset, vertexBytes[i]); // stays on the GPU
+
+		GeometryRange range;
+		range.baseVertex = (GLint)(vertexOffset / stride);
+		range.firstIndex = (GLuint)indices.size();
+		range.indexCount = (GLuint)geometry.elementCount;
+
+		if (!geometry.indexed) { // triangle list, draw it through trivial indices
+			for (GLsizei k = 0; k < geometry.elementCount; k++) {
+				indices.push_back((unsigned int)k);
+			}
+		}
+		else if (geometry.indexType == GL_UNSIGNED_SHORT) { // read back and widen to 32 bit
+			std::vector<unsigned short> shortIndices(geometry.elementCount);
+			glBindBuffer(GL_COPY_READ_BUFFER, geometry.Ebo);
+			glGetBufferSubData(GL_COPY_READ_BUFFER, 0, shortIndices.size() * sizeof(unsigned short), &shortIndices[0]);
+			indices.insert(indices.end(), shortIndices.begin(), shortIndices.end());
+		}
+		else {
+			indices.resize(indices.size() + geometry.elementCount);
+			glBindBuffer(GL_COPY_READ_BUFFER, geometry.Ebo);
+			glGetBufferSubData(GL_COPY_READ_BUFFER, 0, geometry.elementCount * sizeof(unsigned int), &indices[range.firstIndex]);
+		}
+
+		ranges[geometries[i]] = range;
+		vertexOffset += vertexBytes[i];
+	}
+	glBindBuffer(GL_COPY_READ_BUFFER, 0);
+
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, Ebo); // bind the EBO to the VAO
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
+	SetVertexLayout(packed);
+
+	geometriesChanged = false;
+	geometryVersion++;
+	uploadedCommands.clear(); // offsets moved, the commands have to be rewritten
+}
+
+void MultiDrawBatch::Prepare(const TransformBatch& transforms) {
+	drawCalls = 0;
+	if (packets.empty()) {
+		return;
+	}
+	UpdateGeometry(); // a geometry may have shown up that is not in the shared buffers yet (new object or LOD level)
+
+	// one run per texture, submission order inside a run. Nothing camera dependent goes into the order,
+	// so the commands stay the same from frame to frame until the scene itself changes
+	const std::vector<DrawPacket>& batchPackets = packets;
+	std::stable_sort(order.begin(), order.end(), [&batchPackets](unsigned int a, unsigned int b) {
+		return batchPackets[a].texture < batchPackets[b].texture;
+	});
+
+	commands.resize(order.size());
+	objects.resize(order.size());
+	mvps.resize(order.size());
+	runStarts.clear();
+	for (size_t i = 0; i < order.size(); i++) {
+		const DrawPacket& packet = packets[order[i]];
+		if (i == 0 || packet.texture != packets[order[i - 1]].texture) {
+			runStarts.push_back((GLsizei)i);
+		}
+
+		const GeometryRange& range = ranges[packet.geometry];
+		DrawElementsIndirectCommand& command = commands[i];
+		command.count = range.indexCount;
+		command.instanceCount = 1;
+		command.firstIndex = range.firstIndex;
+		command.baseVertex = range.baseVertex;
+		command.baseInstance = 0;
+
+		const ObjectTransform& transform = transforms.transforms[packet.transformIndex];
+		objects[i] = MakeObjectData(packet, transform);
+		mvps[i] = transform.mvp;
+	}
+
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, Ibo);
+	bool commandsChanged = commands.size() != uploadedCommands.size()
+		|| memcmp(&commands[0], &uploadedCommands[0], commands.size() * sizeof(DrawElementsIndirectCommand)) != 0;
+	if (commandsChanged) { // only when objects, geometries or LOD levels changed
+		glBufferData(GL_DRAW_INDIRECT_BUFFER, commands.size() * sizeof(DrawElementsIndirectCommand), &commands[0], GL_STATIC_DRAW);
+		uploadedCommands = commands;
+		commandUploads++;
+	}
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+	Upload(Ssbo, &objects[0], objects.size() * sizeof(ObjectData), objectRange, objectRangeBuffer);
+	Upload(MvpSsbo, &mvps[0], mvps.size() * sizeof(glm::mat4), mvpRange, mvpRangeBuffer);
+}
+
+void MultiDrawBatch::Upload(GLuint fallback, const void* data, GLsizeiptr size, StreamAllocation& range, GLuint& rangeBuffer) {
+	StreamAllocation allocation = stream != nullptr ? stream->AllocateStorage(size) : StreamAllocation{ nullptr, 0, 0 };
+	if (allocation.data != nullptr) { // straight into the mapped segment of this frame
+		memcpy(allocation.data, data, size);
+		range = allocation;
+		rangeBuffer = stream->Buffer;
+	}
+	else {
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, fallback);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, size, nullptr, GL_DYNAMIC_DRAW); // orphan, the previous frame may still read the old storage
+		glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, size, data);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+		range.offset = 0;
+		range.size = size;
+		rangeBuffer = fallback;
+	}
+}
+
+void MultiDrawBatch::Draw(GLint drawOffsetLocation, bool bindTextures) {
+	if (packets.empty()) {
+		return;
+	}
+
+	glBindBufferRange(GL_SHADER_STORAGE_BUFFER, kObjectDataBinding, objectRangeBuffer, objectRange.offset, objectRange.size); // other passes may have bound their own
+	glBindBufferRange(GL_SHADER_STORAGE_BUFFER, kObjectMvpBinding, mvpRangeBuffer, mvpRange.offset, mvpRange.size);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, Ibo);
+	CachedBindVertexArray(Vao);
+	if (!bindTextures) { // depth only, the texture runs do not matter
+		glUniform1i(drawOffsetLocation, 0);
+		glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (void*)0, (GLsizei)order.size(), 0);
+		drawCalls++;
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+		return;
+	}
+	for (size_t run = 0; run < runStarts.size(); run++) {
+		GLsizei first = runStarts[run];
+		GLsizei count = (run + 1 < runStarts.size() ? runStarts[run + 1] : (GLsizei)order.size()) - first;
+		const DrawPacket& runPacket = packets[order[first]];
+		CachedBindTexture(runPacket.textureTarget == GL_TEXTURE_2D_ARRAY ? 1 : 0, runPacket.textureTarget, runPacket.texture);
+		glUniform1i(drawOffsetLocation, first); // gl_DrawID restarts at 0 for every call
+		glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (void*)(first * sizeof(DrawElementsIndirectCommand)), count, 0);
+		drawCalls++;
+	}
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
+
+void MultiDrawBatch::Release() {
+	glDeleteBuffers(1, &Vbo);
+	glDeleteBuffers(1, &Ebo);
+	glDeleteBuffers(1, &Ibo);
+	glDeleteBuffers(1, &Ssbo);
+	glDeleteBuffers(1, &MvpSsbo);
+	CachedDeleteVertexArray(Vao);
+	geometries.clear();
+	ranges.clear();
+}
@@ -0,0 +1,99 @@
+#pragma once
+#include <GL\glew.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include <map>
+#include "GeometryRegistry.h"
+#include "RenderQueue.h"
+#include "StreamRingBuffer.h"
+#include "TransformBatch.h"
+
+#ifndef  MultiDrawBatch_h
+#define MultiDrawBatch_h
+
+const GLuint kObjectDataBinding = 1; // shader storage binding of ObjectBuffer in BatchedShader.vert/.frag
+const GLuint kObjectMvpBinding = 10; // mat4 per object, projection * view * model of the frame (ObjectMvpBuffer)
+
+// per object data of the batched path, mirrors the std430 ObjectData struct of the batched shaders
+struct ObjectData {
+	glm::mat4 model;
+	glm::vec4 normalMatrix[3]; // mat3 columns, std430 pads each to a vec4
+	glm::vec4 materialColor; // rgb, a unused
+	float k_ambient;
+	float k_diffuse;
+	float k_specular;
+	int alpha;
+	glm::vec2 textureScale;
+	glm::vec2 uvOffset; // packed vertex decode parameters, identity for float meshes
+	glm::vec2 uvScale;
+	int octahedralNormals;
+	int textureLayer; // -1 samples the GL_TEXTURE_2D on unit 0
+	glm::vec4 positionOffset; // xyz
+	glm::vec4 positionScale; // xyz
+};
+
+// layout glMultiDrawElementsIndirect reads from GL_DRAW_INDIRECT_BUFFER
+struct DrawElementsIndirectCommand {
+	GLuint count;
+	GLuint instanceCount;
+	GLuint firstIndex;
+	GLint baseVertex;
+	GLuint baseInstance;
+};
+
+// where a geometry lives inside the shared buffers
+struct GeometryRange {
+	GLint baseVertex;
+	GLuint firstIndex;
+	GLuint indexCount;
+};
+
+// object data of a packet: transform, the normal matrix "transform" holds for it, material and vertex decode parameters
+ObjectData MakeObjectData(const DrawPacket& packet, const ObjectTransform& transform);
+
+// draws every packet with a vertex buffer through one glMultiDrawElementsIndirect per texture (per texture array in texture array mode).
+// The vertices of all geometries are copied into one VBO and their indices into one 32 bit EBO,
+// transforms and materials go into an SSBO the batched shaders index with gl_DrawID, the MVPs of the frame into a second one.
+// All geometries have to share the vertex format, which holds since packed_vertices is a global setting.
+class MultiDrawBatch {
+public:
+	GLuint Vao; // layout of the shared buffers
+	GLuint Vbo; // vertices of every known geometry
+	GLuint Ebo; // indices of every known geometry, non-indexed meshes get 0..n-1
+	GLuint Ibo; // indirect commands
+	GLuint Ssbo; // ObjectData, rewritten every frame if there is no stream or it is full
+	GLuint MvpSsbo; // per object MVP, the same fallback as Ssbo
+	StreamRingBuffer* stream; // per frame ring ObjectData is written to
+	unsigned int drawCalls; // glMultiDrawElementsIndirect calls since the last Prepare
+	unsigned int commandUploads; // times the indirect buffer had to be rewritten
+	unsigned int geometryVersion; // bumped whenever the shared buffers were rebuilt and the ranges moved
+	MultiDrawBatch(StreamRingBuffer* stream = nullptr); // creates the buffers, needs a current GL context
+	void Clear(); // empties the batch for the next frame
+	void Add(const DrawPacket& packet); // packet.geometry must not be nullptr
+	void Prepare(const TransformBatch& transforms); // orders the packets, writes the commands and the object data, once per frame before the first Draw
+	void Draw(GLint drawOffsetLocation, bool bindTextures = true); // draws the batch with the bound BatchedShader program, without textures as one call
+	void AddGeometry(const Geometry* geometry); // makes "geometry" part of the shared buffers without drawing it
+	bool UpdateGeometry(); // copies geometries added since the last call into the shared buffers, true if the ranges moved
+	const GeometryRange& Range(const Geometry* geometry) const; // valid after UpdateGeometry
+	void Release(); // deletes the GL objects, the geometries stay with the registry
+private:
+	std::vector<DrawPacket> packets; // added this frame
+	std::vector<unsigned int> order; // indices into packets, in draw order after Draw sorted them
+	std::vector<const Geometry*> geometries; // copied into the shared buffers, in buffer order
+	std::map<const Geometry*, GeometryRange> ranges; // position of each geometry in the shared buffers
+	std::vector<DrawElementsIndirectCommand> commands; // built this frame
+	std::vector<DrawElementsIndirectCommand> uploadedCommands; // content of Ibo
+	std::vector<ObjectData> objects; // built this frame, same order as commands
+	std::vector<glm::mat4> mvps; // built this frame, same order as commands
+	std::vector<GLsizei> runStarts; // first command of each texture run
+	StreamAllocation objectRange; // where Prepare put this frame's ObjectData
+	GLuint objectRangeBuffer; // stream->Buffer or Ssbo
+	StreamAllocation mvpRange; // where Prepare put this frame's MVPs
+	GLuint mvpRangeBuffer; // stream->Buffer or MvpSsbo
+	void Upload(GLuint fallback, const void* data, GLsizeiptr size, StreamAllocation& range, GLuint& rangeBuffer); // this frame's segment of the stream, or orphans "fallback"
+	bool packed; // vertex format of the shared VBO
+	bool geometriesChanged; // "geometries" holds entries that are not in the shared buffers yet
+	void RebuildGeometryBuffers(); // copies every geometry in "geometries" into Vbo/Ebo
+};
+
+#endif /MultiDrawBatch_h/
@@ -0,0 +1,36 @@
+//chunk: per object data of the multi-draw and GPU driven paths
+#ifndef OBJECT_DATA_GLSL
+#define OBJECT_DATA_GLSL
+
+// per object data, one entry per draw command (std430, binding 1), see ObjectData in MultiDrawBatch.h
+struct ObjectData {
+    mat4 model;
+    mat3 normalMatrix;
+    vec4 materialColor;
+    float k_ambient;
+    float k_diffuse;
+    float k_specular;
+    int alpha;
+    vec2 textureScale;
+    vec2 uvOffset;
+    vec2 uvScale;
+    int octahedralNormals;
+    int textureLayer;
+    vec4 positionOffset;
+    vec4 positionScale;
+};
+
+layout (std430, binding = 1) readonly buffer ObjectBuffer {
+    ObjectData objects[];
+};
+
+// projection * view * model of the frame, same index as objects (binding 10, kObjectMvpBinding).
+// The multi-draw batch uploads it, in the GPU driven path CullInstances.comp writes it for the visible instances
+#ifndef OBJECT_MVP_ACCESS
+#define OBJECT_MVP_ACCESS readonly
+#endif
+layout (std430, binding = 10) OBJECT_MVP_ACCESS buffer ObjectMvpBuffer {
+    mat4 objectMvps[];
+};
+
+#endif
@@ -0,0 +1,25 @@
+//chunk: octahedral normal encoding of packed vertices and the G-buffer
+#ifndef OCTAHEDRAL_GLSL
+#define OCTAHEDRAL_GLSL
+
+// unfolds an octahedral encoded normal
+vec3 DecodeOctahedral(vec2 e)
+{
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    if (n.z < 0.0) {
+        n.xy = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+    }
+    return normalize(n);
+}
+
+// folds a unit normal onto the octahedron and unwraps it into the [-1, 1] square
+vec2 EncodeOctahedral(vec3 n)
+{
+    n /= abs(n.x) + abs(n.y) + abs(n.z);
+    if (n.z < 0.0) {
+        n.xy = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+    }
+    return n.xy;
+}
+
+#endif
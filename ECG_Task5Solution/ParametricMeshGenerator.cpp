@@ -0,0 +1,253 @@
+#include "ParametricMeshGenerator.h"
+#include <thread>
+#include <algorithm>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define MESH_GENERATOR_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MESH_GENERATOR_SSE2
+#endif
+
+const size_t kParallelGridPoints = 1 << 16; // below this many sphere grid points one thread is faster
+
+// runs job(first, last) over [0, count), split into one contiguous band per hardware thread
+template <typename Job>
+static void ParallelBands(size_t count, bool parallel, Job job) {
+	size_t threads = parallel ? std::thread::hardware_concurrency() : 1;
+	threads = std::min(threads, count);
+	if (threads <= 1) {
+		job(0, count);
+		return;
+	}
+
+	size_t band = (count + threads - 1) / threads;
+	std::vector<std::thread> workers;
+	for (size_t first = band; first < count; first += band) {
+		workers.emplace_back(job, first, std::min(count, first + band));
+	}
+	job(0, band); // the calling thread takes the first band
+	for (size_t i = 0; i < workers.size(); i++) {
+		workers[i].join();
+	}
+}
+
+// out[i] = scale * values[i]
+static void ScaleRow(float scale, const float* values, float* out, size_t count) {
+	size_t i = 0;
+#if defined(MESH_GENERATOR_AVX2)
+	__m256 scale8 = _mm256_set1_ps(scale);
+	for (; i + 8 <= count; i += 8) {
+		_mm256_storeu_ps(out + i, _mm256_mul_ps(scale8, _mm256_loadu_ps(values + i)));
+	}
+#elif defined(MESH_GENERATOR_SSE2)
+	__m128 scale4 = _mm_set1_ps(scale);
+	for (; i + 4 <= count; i += 4) {
+		_mm_storeu_ps(out + i, _mm_mul_ps(scale4, _mm_loadu_ps(values + i)));
+	}
+#endif
+	for (; i < count; i++) { // scalar tail and fallback
+		out[i] = scale * values[i];
+	}
+}
+
+static inline float* WriteVertex(float* out, float x, float y, float z, float nx, float ny, float nz, float u, float v) {
+	out[0] = x; //vx
+	out[1] = y; //vy
+	out[2] = z; //vz
+	out[3] = nx; //nx
+	out[4] = ny; //ny
+	out[5] = nz; //nz
+	out[6] = u; //u
+	out[7] = v; //v
+	return out + 8;
+}
+
+// spherical uv mapping, same expressions as the original SphereMesh loops
+static float SphereU(float x, float z) {
+	return 0.5 + (atan2(x, z) / (2.0f * glm::pi<float>()));
+}
+
+static float SphereV(float y) {
+	return 0.5 - (asin(y) / glm::pi<float>());
+}
+
+size_t SphereMeshFloatCount(float latitudeSegments, float longitudeSegments) {
+	size_t rings = (size_t)latitudeSegments - 1; // grid rings between the poles
+	size_t segments = (size_t)longitudeSegments;
+	return (2 * segments * 3 + (rings - 1) * segments * 6) * 8; // two caps with one triangle per segment, two triangles per side quad
+}
+
+void GenerateSphereMesh(float radius, float latitudeSegments, float longitudeSegments, float* out) {
+	size_t rings = (size_t)latitudeSegments - 1;
+	size_t segments = (size_t)longitudeSegments;
+	bool parallel = rings * segments >= kParallelGridPoints;
+
+	// per ring tables
+	std::vector<float> ringRadius(rings); // radius * sin(verticalAngle)
+	std::vector<float> ringHeight(rings); // radius * cos(verticalAngle)
+	std::vector<float> ringV(rings);
+	for (size_t r = 0; r < rings; r++) {
+		float verticalAngle = float(r + 1) * glm::pi<float>() / float(latitudeSegments);
+		ringRadius[r] = radius * glm::sin(verticalAngle);
+		ringHeight[r] = radius * glm::cos(verticalAngle);
+		ringV[r] = SphereV(ringHeight[r]);
+	}
+
+	// per segment tables
+	std::vector<float> segmentCos(segments);
+	std::vector<float> segmentSin(segments);
+	for (size_t j = 0; j < segments; j++) {
+		float horizontalAngle = float(j) * 2.0f * glm::pi<float>() / float(longitudeSegments);
+		segmentCos[j] = glm::cos(horizontalAngle);
+		segmentSin[j] = glm::sin(horizontalAngle);
+	}
+
+	// grid positions and u, ring by ring
+	std::vector<float> gridX(rings * segments);
+	std::vector<float> gridZ(rings * segments);
+	std::vector<float> gridU(rings * segments);
+	ParallelBands(rings, parallel, [&](size_t first, size_t last) {
+		for (size_t r = first; r < last; r++) {
+			size_t row = r * segments;
+			ScaleRow(ringRadius[r], &segmentCos[0], &gridX[row], segments);
+			ScaleRow(ringRadius[r], &segmentSin[0], &gridZ[row], segments);
+			for (size_t j = 0; j < segments; j++) {
+				gridU[row + j] = SphereU(gridX[row + j], gridZ[row + j]);
+			}
+		}
+	});
+
+	float* top = out;
+	float* bottom = top + segments * 3 * 8;
+	float* side = bottom + segments * 3 * 8;
+
+	// top segments
+	float topY = float(1.0 * radius);
+	float topU = SphereU(0.0f, 0.0f);
+	float topV = SphereV(topY);
+	for (size_t i = 0; i < segments; i++) {
+		size_t next = i == segments - 1 ? 0 : i + 1;
+		top = WriteVertex(top, 0.0f, topY, 0.0f, 0.0f, topY, 0.0f, topU, topV);
+		top = WriteVertex(top, gridX[next], ringHeight[0], gridZ[next], gridX[next], ringHeight[0], gridZ[next], gridU[next], ringV[0]);
+		top = WriteVertex(top, gridX[i], ringHeight[0], gridZ[i], gridX[i], ringHeight[0], gridZ[i], gridU[i], ringV[0]);
+	}
+
+	// bottom segments, the first ring mirrored
+	float bottomY = float(-1.0 * radius);
+	float bottomU = SphereU(0.0f, 0.0f);
+	float bottomV = SphereV(bottomY);
+	float mirroredY = -1.0f * ringHeight[0];
+	float mirroredV = SphereV(mirroredY);
+	for (size_t i = 0; i < segments; i++) {
+		size_t next = i == segments - 1 ? 0 : i + 1;
+		bottom = WriteVertex(bottom, 0.0f, bottomY, 0.0f, 0.0f, bottomY, 0.0f, bottomU, bottomV);
+		bottom = WriteVertex(bottom, gridX[i], mirroredY, gridZ[i], gridX[i], mirroredY, gridZ[i], gridU[i], mirroredV);
+		bottom = WriteVertex(bottom, gridX[next], mirroredY, gridZ[next], gridX[next], mirroredY, gridZ[next], gridU[next], mirroredV);
+	}
+
+	// side segments, every band writes its own slice of the output
+	ParallelBands(rings - 1, parallel, [&](size_t first, size_t last) {
+		for (size_t r = first; r < last; r++) {
+			float* quad = side + r * segments * 6 * 8;
+			for (size_t i = 0; i < segments; i++) {
+				size_t next = i == segments - 1 ? 0 : i + 1;
+				size_t a = r * segments + i; // v0, v5
+				size_t b = (r + 1) * segments + next; // v1, v4
+				size_t c = (r + 1) * segments + i; // v2
+				size_t d = r * segments + next; // v3
+				float yr = ringHeight[r];
+				float yn = ringHeight[r + 1];
+				bool zeroUv = float(int(i)) == longitudeSegments - 17; // uv override of the original loop
+
+				//triangle 1
+				quad = WriteVertex(quad, gridX[a], yr, gridZ[a], gridX[a], yr, gridZ[a], zeroUv ? 0.0f : gridU[a], zeroUv ? 0.0f : ringV[r]);
+				quad = WriteVertex(quad, gridX[b], yn, gridZ[b], gridX[b], yn, gridZ[b], gridU[b], ringV[r + 1]);
+				quad = WriteVertex(quad, gridX[c], yn, gridZ[c], gridX[c], yn, gridZ[c], gridU[c], ringV[r + 1]);
+
+				//triangle 2
+				quad = WriteVertex(quad, gridX[d], yr, gridZ[d], gridX[d], yr, gridZ[d], gridU[d], ringV[r]);
+				quad = WriteVertex(quad, gridX[b], yn, gridZ[b], gridX[b], yn, gridZ[b], gridU[b], ringV[r + 1]);
+				quad = WriteVertex(quad, gridX[a], yr, gridZ[a], gridX[a], yr, gridZ[a], gridU[a], ringV[r]);
+			}
+		}
+	});
+}
+
+BoundingVolume SphereMeshBounds(float radius) {
+	BoundingVolume bounds = MakeBounds(glm::vec3(-radius), glm::vec3(radius)); // the tessellation only ever lies inside the sphere
+	bounds.radius = radius;
+	return bounds;
+}
+
+size_t CylinderMeshFloatCount(int segments) {
+	return (size_t)segments * 12 * 8; // one triangle per segment and cap, two per side face
+}
+
+BoundingVolume CylinderMeshBounds(float radius, float height) {
+	return MakeBounds(glm::vec3(-radius, -0.5f * height, -radius), glm::vec3(radius, 0.5f * height, radius)); // centered on the origin
+}
+
+void GenerateCylinderMesh(float radius, float height, int segments, float* out) {
+	float angleIncrement = (std::acos(-1.0) * 2.0f) / segments; // angle between each vertex of the cylinder
+	typedef decltype(cos(angleIncrement)) Trig; // keep the precision of the original cos/sin calls
+
+	// one entry per ring vertex plus the closing angle used by the last uv
+	std::vector<Trig> angleCos(segments + 1);
+	std::vector<Trig> angleSin(segments + 1);
+	for (int i = 0; i <= segments; i++) {
+		angleCos[i] = cos(i * angleIncrement);
+		angleSin[i] = sin(i * angleIncrement);
+	}
+
+	std::vector<glm::vec3> ring(segments);
+	std::vector<glm::vec2> capUv(segments + 1);
+	for (int i = 0; i < segments; i++) {
+		ring[i] = glm::vec3(angleCos[i] * radius, 0.5f * height, angleSin[i] * radius);
+	}
+	for (int i = 0; i <= segments; i++) {
+		float u = (1 + angleCos[i]) / 2;
+		float v = (1 + angleSin[i]) / 2;
+		capUv[i] = glm::vec2(u, v);
+	}
+
+	// top circle
+	float topY = 1.0f * 0.5f * height;
+	for (int i = 0; i < segments; i++) {
+		const glm::vec3& first = ring[i == segments - 1 ? 0 : i + 1];
+		out = WriteVertex(out, 0.0f, topY, 0.0f, 0.0f, 1.0f, 0.0f, 0.5f, 0.5f);
+		out = WriteVertex(out, first.x, 1.0f * first.y, first.z, 0.0f, 1.0f, 0.0f, capUv[i + 1].x, capUv[i + 1].y);
+		out = WriteVertex(out, ring[i].x, 1.0f * ring[i].y, ring[i].z, 0.0f, 1.0f, 0.0f, capUv[i].x, capUv[i].y);
+	}
+
+	// bottom circle
+	float bottomY = -1.0f * 0.5f * height;
+	for (int i = 0; i < segments; i++) {
+		const glm::vec3& first = ring[i == segments - 1 ? 0 : i + 1];
+		out = WriteVertex(out, 0.0f, bottomY, 0.0f, 0.0f, -1.0f, 0.0f, 0.5f, 0.5f);
+		out = WriteVertex(out, ring[i].x, -1.0f * ring[i].y, ring[i].z, 0.0f, -1.0f, 0.0f, capUv[i].x, capUv[i].y);
+		out = WriteVertex(out, first.x, -1.0f * first.y, first.z, 0.0f, -1.0f, 0.0f, capUv[i + 1].x, capUv[i + 1].y);
+	}
+
+	// 1 side face per segment, each face has 6 vertices
+	glm::vec3 midPoint = glm::vec3(0.0f, 0.5f * height, 0.0f);
+	for (int i = 0; i < segments; i++) {
+		const glm::vec3& upper0 = ring[i];
+		const glm::vec3& upper1 = ring[i == segments - 1 ? 0 : i + 1];
+		glm::vec3 lower0(upper0.x, -1 * upper0.y, upper0.z);
+		glm::vec3 lower1(upper1.x, -1 * upper1.y, upper1.z);
+		float u0 = (i) / (float)segments;
+		float u1 = (i + 1) / (float)segments;
+
+		//triangle 1
+		out = WriteVertex(out, upper0.x, upper0.y, upper0.z, upper0.x - midPoint.x, upper0.y - midPoint.y, upper0.z - midPoint.z, u0, 1.0f);
+		out = WriteVertex(out, upper1.x, upper1.y, upper1.z, upper1.x - midPoint.x, upper1.y - midPoint.y, upper1.z - midPoint.z, u1, 1.0f);
+		out = WriteVertex(out, lower0.x, lower0.y, lower0.z, lower0.x - midPoint.x, lower0.y - -1 * midPoint.y, lower0.z - midPoint.z, u0, 0.0f);
+
+		//triangle 2
+		out = WriteVertex(out, upper1.x, upper1.y, upper1.z, upper1.x - midPoint.x, upper1.y - midPoint.y, upper1.z - midPoint.z, u1, 1.0f);
+		out = WriteVertex(out, lower1.x, lower1.y, lower1.z, lower1.x - midPoint.x, lower1.y - -1 * midPoint.y, lower1.z - midPoint.z, u1, 0.0f);
+		out = WriteVertex(out, lower0.x, lower0.y, lower0.z, lower0.x - midPoint.x, lower0.y - -1 * midPoint.y, lower0.z - midPoint.z, u0, 0.0f);
+	}
+}
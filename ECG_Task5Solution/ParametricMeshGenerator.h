@@ -0,0 +1,35 @@
+#pragma once
+#include <glm\detail\type_mat.hpp>
+#include <glm/glm.hpp>
+#include <vector>
+#include <cstddef>
+#include <glm\gtc\constants.hpp>
+#include "BoundingVolume.h"
+
+#ifndef  ParametricMeshGenerator_h
+#define ParametricMeshGenerator_h
+
+// Table driven generators for the sphere and cylinder triangle lists. The output is bit-identical to the
+// original per-vertex SphereMesh/CylinderMesh loops, but every sin/cos/atan2/asin is evaluated once per
+// grid point, ring positions are computed with SSE/AVX2 where available and large spheres are split into
+// latitude bands across hardware threads. Segment counts are expected to be whole numbers.
+
+// number of floats GenerateSphereMesh writes
+size_t SphereMeshFloatCount(float latitudeSegments, float longitudeSegments);
+
+// writes the interleaved position/normal/uv triangle list of a sphere into "out"
+void GenerateSphereMesh(float radius, float latitudeSegments, float longitudeSegments, float* out);
+
+// bounds around every vertex GenerateSphereMesh writes, without reading "out" back (it may be write-only mapped memory)
+BoundingVolume SphereMeshBounds(float radius);
+
+// number of floats GenerateCylinderMesh writes
+size_t CylinderMeshFloatCount(int segments);
+
+// writes the interleaved position/normal/uv triangle list of a cylinder into "out"
+void GenerateCylinderMesh(float radius, float height, int segments, float* out);
+
+// bounds around every vertex GenerateCylinderMesh writes
+BoundingVolume CylinderMeshBounds(float radius, float height);
+
+#endif /ParametricMeshGenerator_h/
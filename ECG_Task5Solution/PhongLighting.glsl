@@ -0,0 +1,17 @@
+//chunk: the phong terms shared by every light type, forward and deferred
+#ifndef PHONG_LIGHTING_GLSL
+#define PHONG_LIGHTING_GLSL
+
+// ambient, diffuse and specular of a light of "color" seen from "lightDir" (unit, towards the light), not attenuated
+vec3 PhongLight(vec3 norm, vec3 lightDir, vec3 viewDir, vec3 color, float k_ambient, float k_diffuse, float k_specular, float shininess)
+{
+    vec3 ambient = k_ambient * color;
+    float diff = max(dot(norm, lightDir), 0.0);
+    vec3 diffuse = k_diffuse * diff * color;
+    vec3 reflectDir = reflect(-lightDir, norm);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), shininess);
+    vec3 specular = k_specular * spec * color;
+    return ambient + diffuse + specular;
+}
+
+#endif
@@ -1,21 +1,67 @@
-//vertex shader
+//vertex shader, with GOURAUD defined the lighting happens here per vertex (see Surface.frag for the features)
 #version 430
 layout (location = 0) in vec3 position;
 layout (location = 1) in vec3 normal;
 layout (location = 2) in vec2 uv;
 
+#include "FrameData.glsl"
+
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 proj;
+uniform mat4 mvp; // projection * view * model, computed once per object on the CPU
+uniform mat3 normalMatrix; // inverse transpose of the upper 3x3 of model, keeps normals right under non-uniform scale
+uniform vec2 textureScale = vec2(1.0); // uv repeat of the material
 
 out vec3 Normal;
 out vec3 FragPos;
 out vec2 Uv;
 
+// decode parameters of packed meshes, identity for float meshes
+uniform vec3 positionOffset = vec3(0.0);
+uniform vec3 positionScale = vec3(1.0);
+uniform vec2 uvOffset = vec2(0.0);
+uniform vec2 uvScale = vec2(1.0);
+uniform bool octahedralNormals = false;
+
+#include "Octahedral.glsl"
+
+#ifdef GOURAUD
+#ifdef POINT_LIGHTS
+#include "ClusteredLights.glsl"
+#endif
+#include "PhongLighting.glsl"
+
+out vec3 LightingColor; // resulting color from lighting calculations
+
+uniform float k_ambient;
+uniform float k_diffuse;
+uniform float k_specular;
+
+uniform int alpha;
+#endif
+
+invariant gl_Position; // the depth pre-pass runs this shader too, GL_EQUAL needs bit identical depth in both passes
+
 void main()
 {
-    gl_Position = proj * view * model * vec4(position, 1.0);
-    FragPos = vec3(model * vec4(position,1.0));
-    Normal = mat3(transpose(inverse(model))) * normal;
-    Uv = uv;
+    vec3 objectPosition = positionOffset + position * positionScale;
+    vec3 objectNormal = octahedralNormals ? DecodeOctahedral(normal.xy) : normal;
+
+    gl_Position = mvp * vec4(objectPosition, 1.0);
+    FragPos = vec3(model * vec4(objectPosition,1.0));
+    Normal = normalMatrix * objectNormal;
+    Uv = (uvOffset + uv * uvScale) * textureScale;
+
+#ifdef GOURAUD
+    vec3 norm = normalize(Normal);
+    vec3 viewDir = normalize(viewPos - FragPos);
+    LightingColor = vec3(0.0);
+#ifdef POINT_LIGHTS
+    // the lights of the froxel the vertex falls into, w of the clip position is the view depth (negative behind the camera)
+    vec2 tile = (gl_Position.xy / gl_Position.w * 0.5 + 0.5) * vec2(clusterGrid.xy);
+    LightingColor += ClusteredPointLights(ClusterIndex(tile, max(gl_Position.w, 1e-4)), FragPos, norm, viewDir, k_ambient, k_diffuse, k_specular, float(alpha));
+#endif
+#ifdef DIRECTIONAL_LIGHT
+    LightingColor += PhongLight(norm, normalize(-dLightDirection), viewDir, dLightColor, k_ambient, k_diffuse, k_specular, 10.0);
+#endif
+#endif
 } 
\ No newline at end of file
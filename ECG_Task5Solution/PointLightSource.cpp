@@ -1,4 +1,5 @@
 #include "PointLightSource.h"
+#include "GLStateCache.h"
 
 PointLightSource::PointLightSource() {
 
@@ -12,7 +13,7 @@ PointLightSource::PointLightSource(glm::mat4 transform, glm::vec3 _color, glm::v
 	attenuation_Quadratic = _attenuation_Quadratic;
 	mesh = BasicCubeMesh();
 	glGenVertexArrays(1, &Vao);
-	glBindVertexArray(Vao);
+	CachedBindVertexArray(Vao);
 	glGenBuffers(1, &Vbo);
 	glBindBuffer(GL_ARRAY_BUFFER, Vbo);
 	glBufferData(GL_ARRAY_BUFFER, sizeof(mesh.vertices), mesh.vertices, GL_STATIC_DRAW); // buffer the vertex data
@@ -0,0 +1,29 @@
+//chunk: the point lights of ClusteredLights (std430, bindings 6 to 8), see ClusteredLighting.h
+#ifndef POINT_LIGHTS_GLSL
+#define POINT_LIGHTS_GLSL
+
+#include "PhongLighting.glsl"
+
+layout (std430, binding = 6) readonly buffer LightPositions {
+    vec4 lightPositionRange[]; // world position, range
+};
+layout (std430, binding = 7) readonly buffer LightColors {
+    vec4 lightColor[];
+};
+layout (std430, binding = 8) readonly buffer LightAttenuations {
+    vec4 lightAttenuation[]; // constant, linear, quadratic
+};
+
+// phong terms of "light" at "position", faded out towards the light range so volumes and froxel borders stay invisible
+vec3 PointLight(uint light, vec3 position, vec3 norm, vec3 viewDir, float k_ambient, float k_diffuse, float k_specular, float shininess)
+{
+    vec3 toLight = lightPositionRange[light].xyz - position;
+    float distance = length(toLight);
+    vec3 k = lightAttenuation[light].xyz;
+    float range = lightPositionRange[light].w;
+    float fade = range > 0.0 ? clamp(1.0 - pow(distance / range, 4.0), 0.0, 1.0) : 0.0; // range 0 never reaches the cutoff, 0 / 0 would be NaN
+    float attenuation = fade * fade / (k.x + k.y * distance + k.z * (distance * distance));
+    return PhongLight(norm, toLight / max(distance, 1e-5), viewDir, lightColor[light].rgb, k_ambient, k_diffuse, k_specular, shininess) * attenuation;
+}
+
+#endif
@@ -0,0 +1,31 @@
+#include "ProceduralMesh.h"
+#include "ParametricMeshGenerator.h"
+#include "GLStateCache.h"
+
+static GLuint emptyVao = 0; // core profile draws need a VAO bound, even without attributes
+
+GLsizei ProceduralVertexCount(PrimitiveType type, int segments0, int segments1) {
+	switch (type) {
+	case PRIMITIVE_SPHERE:
+		return (GLsizei)(SphereMeshFloatCount((float)segments0, (float)segments1) / 8);
+	case PRIMITIVE_CYLINDER:
+		return (GLsizei)(CylinderMeshFloatCount(segments0) / 8);
+	default:
+		return 0; // cuboids are not built procedurally
+	}
+}
+
+void DrawProcedural(PrimitiveType type, int segments0, int segments1) {
+	if (emptyVao == 0) {
+		glGenVertexArrays(1, &emptyVao);
+	}
+	CachedBindVertexArray(emptyVao); // no attributes, the vertex shader works from gl_VertexID
+	glDrawArrays(GL_TRIANGLES, 0, ProceduralVertexCount(type, segments0, segments1));
+}
+
+void ReleaseProceduralResources() {
+	if (emptyVao != 0) {
+		CachedDeleteVertexArray(emptyVao);
+		emptyVao = 0;
+	}
+}
@@ -0,0 +1,19 @@
+#pragma once
+#include <GL\glew.h>
+#include "GeometryRegistry.h"
+
+#ifndef  ProceduralMesh_h
+#define ProceduralMesh_h
+
+// number of vertices ProceduralShader.vert builds for a sphere (latitude, longitude segments) or a cylinder (segments, unused),
+// the same triangle list GenerateSphereMesh/GenerateCylinderMesh write
+GLsizei ProceduralVertexCount(PrimitiveType type, int segments0, int segments1);
+
+// draws a primitive with the bound ProceduralShader program and no vertex buffer at all,
+// the primitive uniforms (type, segments) have to be set already, the dimensions come with the model matrix
+void DrawProcedural(PrimitiveType type, int segments0, int segments1);
+
+// deletes the empty VAO the procedural draws are issued with
+void ReleaseProceduralResources();
+
+#endif /ProceduralMesh_h/
@@ -0,0 +1,136 @@
+//vertex shader, builds sphere and cylinder vertices from gl_VertexID without any vertex buffer
+//the vertex order matches GenerateSphereMesh/GenerateCylinderMesh, draw ProceduralVertexCount vertices as GL_TRIANGLES
+//builds the unit sphere/cylinder, the dimensions are part of the model matrix
+#version 430
+
+#include "FrameData.glsl"
+
+uniform mat4 model;
+uniform mat4 mvp; // projection * view * model, computed once per object on the CPU
+uniform mat3 normalMatrix; // inverse transpose of the upper 3x3 of model
+uniform vec2 textureScale = vec2(1.0); // uv repeat of the material
+
+uniform int primitiveType; // 0 sphere, 1 cylinder (PrimitiveType)
+uniform ivec2 primitiveSegments; // sphere: latitude and longitude segments, cylinder: segments
+
+out vec3 Normal;
+out vec3 FragPos;
+out vec2 Uv;
+
+const float PI = 3.14159265358979;
+
+// ring and segment offsets of the 6 corners of a sphere side quad (a, b, c, d, b, a)
+const ivec2 sphereQuadCorners[6] = ivec2[6](ivec2(0, 0), ivec2(1, 1), ivec2(1, 0), ivec2(0, 1), ivec2(1, 1), ivec2(0, 0));
+
+// segment offset and upper (1) or lower (0) ring of the 6 corners of a cylinder side face
+const ivec2 cylinderFaceCorners[6] = ivec2[6](ivec2(0, 1), ivec2(1, 1), ivec2(0, 0), ivec2(1, 1), ivec2(1, 0), ivec2(0, 0));
+
+// unit direction of a sphere grid point, "ring" counts from the ring next to the top pole
+vec3 SphereDirection(int ring, int segment)
+{
+    float verticalAngle = float(ring + 1) * PI / float(primitiveSegments.x);
+    float horizontalAngle = float(segment % primitiveSegments.y) * 2.0 * PI / float(primitiveSegments.y);
+    return vec3(sin(verticalAngle) * cos(horizontalAngle), cos(verticalAngle), sin(verticalAngle) * sin(horizontalAngle));
+}
+
+// spherical uv mapping of SphereMesh
+vec2 SphereUv(vec3 direction)
+{
+    return vec2(0.5 + atan(direction.x, direction.z) / (2.0 * PI), 0.5 - asin(direction.y) / PI);
+}
+
+void BuildSphereVertex(int id, out vec3 position, out vec3 normal, out vec2 uv)
+{
+    int segments = primitiveSegments.y;
+    int capVertices = segments * 3;
+    vec3 direction;
+
+    if (id < 2 * capVertices) { // top and bottom caps, one triangle per segment
+        bool bottom = id >= capVertices;
+        int triangle = (id % capVertices) / 3;
+        int corner = id % 3;
+        if (corner == 0) { // pole
+            direction = vec3(0.0, bottom ? -1.0 : 1.0, 0.0);
+            uv = vec2(0.5, bottom ? 1.0 : 0.0);
+        }
+        else {
+            // the top cap winds next then current, the bottom one current then next
+            int segment = triangle + ((corner == 1) != bottom ? 1 : 0);
+            direction = SphereDirection(0, segment);
+            direction.y = bottom ? -direction.y : direction.y; // the bottom cap mirrors the first ring
+            uv = SphereUv(direction);
+        }
+    }
+    else { // side quads, two triangles each
+        int side = id - 2 * capVertices;
+        int ring = side / (segments * 6);
+        int segment = (side / 6) % segments;
+        int corner = side % 6;
+        direction = SphereDirection(ring + sphereQuadCorners[corner].x, segment + sphereQuadCorners[corner].y);
+        uv = SphereUv(direction);
+        if (corner == 0 && segment == segments - 17) {
+            uv = vec2(0.0); // uv override of the original loop
+        }
+    }
+
+    position = direction;
+    normal = direction;
+}
+
+void BuildCylinderVertex(int id, out vec3 position, out vec3 normal, out vec2 uv)
+{
+    int segments = primitiveSegments.x;
+    int capVertices = segments * 3;
+    float radius = 1.0;
+    float halfLength = 0.5;
+    float angleIncrement = 2.0 * PI / float(segments);
+
+    if (id < 2 * capVertices) { // top and bottom circles, one triangle per segment
+        bool bottom = id >= capVertices;
+        int triangle = (id % capVertices) / 3;
+        int corner = id % 3;
+        float y = bottom ? -halfLength : halfLength;
+        normal = vec3(0.0, bottom ? -1.0 : 1.0, 0.0);
+        if (corner == 0) { // center
+            position = vec3(0.0, y, 0.0);
+            uv = vec2(0.5);
+        }
+        else {
+            // the top circle winds next then current, the bottom one current then next
+            float angle = float(triangle + ((corner == 1) != bottom ? 1 : 0)) * angleIncrement;
+            position = vec3(cos(angle) * radius, y, sin(angle) * radius);
+            uv = (1.0 + vec2(cos(angle), sin(angle))) / 2.0;
+        }
+    }
+    else { // side faces, two triangles each
+        int side = id - 2 * capVertices;
+        int face = side / 6;
+        int corner = side % 6;
+        int segment = face + cylinderFaceCorners[corner].x;
+        bool upper = cylinderFaceCorners[corner].y == 1;
+        float angle = float(segment % segments) * angleIncrement;
+        position = vec3(cos(angle) * radius, upper ? halfLength : -halfLength, sin(angle) * radius);
+        normal = vec3(position.x, 0.0, position.z);
+        uv = vec2(float(segment) / float(segments), upper ? 1.0 : 0.0);
+    }
+}
+
+invariant gl_Position; // the depth pre-pass runs this shader too, GL_EQUAL needs bit identical depth in both passes
+
+void main()
+{
+    vec3 objectPosition;
+    vec3 objectNormal;
+    vec2 uv;
+    if (primitiveType == 0) {
+        BuildSphereVertex(gl_VertexID, objectPosition, objectNormal, uv);
+    }
+    else {
+        BuildCylinderVertex(gl_VertexID, objectPosition, objectNormal, uv);
+    }
+
+    gl_Position = mvp * vec4(objectPosition, 1.0);
+    FragPos = vec3(model * vec4(objectPosition,1.0));
+    Normal = normalMatrix * objectNormal;
+    Uv = uv * textureScale;
+}
@@ -0,0 +1,125 @@
+#include "ProgramBinaryCache.h"
+#include <direct.h>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+const unsigned int kProgramCacheMagic = 0x31434250; // "PBC1", file header: magic, binary format, binary length, then the binary
+const unsigned long long kFnvOffsetBasis = 14695981039346656037ull;
+const unsigned long long kFnvPrime = 1099511628211ull;
+
+static bool cacheEnabled = false;
+static unsigned int cacheHits = 0;
+static std::string driverIdentity; // vendor, renderer and version, read once the context exists
+
+static unsigned long long HashBytes(unsigned long long hash, const char* bytes, size_t length) {
+	for (size_t i = 0; i < length; i++) {
+		hash ^= (unsigned char)bytes[i];
+		hash *= kFnvPrime;
+	}
+	return hash;
+}
+
+static std::string CachePath(unsigned long long key) {
+	char name[32];
+	snprintf(name, sizeof(name), "%016llx.bin", key);
+	return std::string(kProgramCacheDirectory) + "/" + name;
+}
+
+void EnableProgramCache(bool enable) {
+	cacheEnabled = false;
+	if (!enable) {
+		return;
+	}
+	GLint formats = 0;
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+	if (formats <= 0) {
+		return; // glGetProgramBinary would have nothing to return
+	}
+
+	driverIdentity.clear();
+	const GLenum names[3] = { GL_VENDOR, GL_RENDERER, GL_VERSION };
+	for (int i = 0; i < 3; i++) {
+		const GLubyte* value = glGetString(names[i]);
+		driverIdentity += value != nullptr ? (const char*)value : "";
+		driverIdentity += '\n';
+	}
+	_mkdir(kProgramCacheDirectory); // fails harmlessly if it exists
+	cacheEnabled = true;
+}
+
+unsigned long long ProgramCacheKey(const std::vector<std::string>& sources) {
+	unsigned long long hash = HashBytes(kFnvOffsetBasis, driverIdentity.c_str(), driverIdentity.size());
+	for (size_t i = 0; i < sources.size(); i++) {
+		hash = HashBytes(hash, sources[i].c_str(), sources[i].size() + 1); // with the terminator, so moving text between stages changes the key
+	}
+	return hash;
+}
+
+GLuint LoadProgramBinary(unsigned long long key) {
+	if (!cacheEnabled) {
+		return 0;
+	}
+	std::ifstream is(CachePath(key), std::ios::binary);
+	if (!is) {
+		return 0; // first run with this source and driver
+	}
+
+	unsigned int header[3] = { 0, 0, 0 };
+	is.read((char*)header, sizeof(header));
+	if (!is || header[0] != kProgramCacheMagic || header[2] == 0) {
+		return 0;
+	}
+	std::vector<char> binary(header[2]);
+	is.read(&binary[0], binary.size());
+	if (!is) {
+		return 0; // truncated, written by a run that died halfway
+	}
+
+	GLuint program = glCreateProgram();
+	glProgramBinary(program, (GLenum)header[1], &binary[0], (GLsizei)binary.size());
+	GLint isLinked = GL_FALSE;
+	glGetProgramiv(program, GL_LINK_STATUS, &isLinked);
+	if (isLinked == GL_FALSE) { // the driver may reject its own binaries any time, e.g. after an update with the same version string
+		glDeleteProgram(program);
+		return 0;
+	}
+	cacheHits++;
+	return program;
+}
+
+void MarkProgramRetrievable(GLuint program) {
+	if (cacheEnabled) {
+		glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+	}
+}
+
+void StoreProgramBinary(GLuint program, unsigned long long key) {
+	if (!cacheEnabled) {
+		return;
+	}
+	GLint isLinked = GL_FALSE;
+	glGetProgramiv(program, GL_LINK_STATUS, &isLinked);
+	GLint length = 0;
+	glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+	if (isLinked == GL_FALSE || length <= 0) {
+		return;
+	}
+
+	std::vector<char> binary(length);
+	GLenum format = 0;
+	glGetProgramBinary(program, length, &length, &format, &binary[0]);
+
+	std::string path = CachePath(key);
+	std::ofstream os(path, std::ios::binary | std::ios::trunc);
+	unsigned int header[3] = { kProgramCacheMagic, (unsigned int)format, (unsigned int)length };
+	os.write((const char*)header, sizeof(header));
+	os.write(&binary[0], length);
+	if (!os) {
+		std::cerr << "WARNING: program binary " << path << " could not be written\n";
+	}
+}
+
+unsigned int ProgramCacheHits() {
+	return cacheHits;
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include <GL\glew.h>
+#include <string>
+#include <vector>
+
+#ifndef  ProgramBinaryCache_h
+#define ProgramBinaryCache_h
+
+const char* const kProgramCacheDirectory = "shader_cache"; // next to the executable's working directory, one file per program
+
+// turns the on-disk cache on or off, off until called. Needs a current GL context, stays off if the driver has no binary formats
+void EnableProgramCache(bool enable);
+
+// key of the program linked from "sources": FNV-1a over the assembled source text of every stage (the feature #defines
+// are part of it) and the GL vendor, renderer and version strings, so a driver update or an edited chunk misses
+unsigned long long ProgramCacheKey(const std::vector<std::string>& sources);
+
+// program loaded from the binary stored under "key", 0 if there is none or the driver rejected it (compile from source then)
+GLuint LoadProgramBinary(unsigned long long key);
+
+// call before glLinkProgram of a program that is going to be stored
+void MarkProgramRetrievable(GLuint program);
+
+// writes the linked "program" under "key", nothing if the cache is off or the program did not link
+void StoreProgramBinary(GLuint program, unsigned long long key);
+
+// programs LoadProgramBinary returned since startup
+unsigned int ProgramCacheHits();
+
+#endif /ProgramBinaryCache_h/
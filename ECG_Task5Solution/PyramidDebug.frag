@@ -0,0 +1,15 @@
+//fragment shader of the depth pyramid debug view, shows one level with the depth range stretched so near geometry stands out
+#version 430
+
+in vec2 Uv;
+out vec4 FragColor;
+
+uniform sampler2D depthPyramid;
+uniform float level;
+
+void main()
+{
+    float depth = textureLod(depthPyramid, Uv, level).r;
+    float shade = pow(depth, 64.0); // perspective depth crowds near 1.0
+    FragColor = vec4(vec3(shade), 1.0);
+}
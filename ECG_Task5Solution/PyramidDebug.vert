@@ -0,0 +1,11 @@
+//vertex shader of the depth pyramid debug view, one triangle covering the viewport, no vertex buffer
+#version 430
+
+out vec2 Uv;
+
+void main()
+{
+    vec2 corner = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2); // (0,0) (2,0) (0,2)
+    Uv = corner;
+    gl_Position = vec4(corner * 2.0 - 1.0, 0.0, 1.0);
+}
@@ -0,0 +1,70 @@
+#include "RenderQueue.h"
+
+// key layout from the most to the least significant bits: program, texture, VAO, front to back depth.
+// GL names are small integers, if one ever exceeds its field the packets still draw correctly, only less grouped
+const int kProgramBits = 10;
+const int kTextureBits = 14;
+const int kVaoBits = 16;
+const int kDepthBits = 24;
+
+RenderQueue::RenderQueue(float _depthRange) {
+	depthRange = _depthRange;
+}
+
+void RenderQueue::Clear() {
+	packets.clear();
+	order.clear();
+}
+
+void RenderQueue::Submit(DrawPacket packet, const Shader* shader, GLuint program, glm::vec3 cameraPosition) {
+	glm::vec3 center = glm::vec3((*packet.transform)[3]); // world space translation of the object
+	float depth = glm::length(center - cameraPosition);
+	GLuint vao = packet.geometry != nullptr ? packet.geometry->Vao : 0;
+
+	packet.shader = shader;
+	packet.key = MakeSortKey(program, packet.texture, vao, depth);
+	packets.push_back(packet);
+}
+
+unsigned long long RenderQueue::MakeSortKey(GLuint program, GLuint texture, GLuint vao, float depth) const {
+	float normalizedDepth = glm::clamp(depth / depthRange, 0.0f, 1.0f);
+	unsigned long long depthBits = (unsigned long long)(normalizedDepth * ((1 << kDepthBits) - 1));
+
+	unsigned long long key = program & ((1 << kProgramBits) - 1);
+	key = (key << kTextureBits) | (texture & ((1 << kTextureBits) - 1));
+	key = (key << kVaoBits) | (vao & ((1 << kVaoBits) - 1));
+	key = (key << kDepthBits) | depthBits;
+	return key;
+}
+
+void RenderQueue::Sort() {
+	size_t count = packets.size();
+	order.resize(count);
+	scratch.resize(count);
+	for (size_t i = 0; i < count; i++) {
+		order[i].key = packets[i].key;
+		order[i].packet = (unsigned int)i;
+	}
+
+	// 8 passes of one byte each, stable, so the earlier passes keep ordering the lower bytes
+	for (int shift = 0; shift < 64; shift += 8) {
+		size_t histogram[256] = { 0 };
+		for (size_t i = 0; i < count; i++) {
+			histogram[(order[i].key >> shift) & 0xFF]++;
+		}
+		if (count == 0 || histogram[(order[0].key >> shift) & 0xFF] == count) {
+			continue; // every key has the same byte here, the pass would not move anything
+		}
+
+		size_t offset = 0;
+		for (int bucket = 0; bucket < 256; bucket++) { // prefix sum, histogram becomes the first slot of each bucket
+			size_t bucketCount = histogram[bucket];
+			histogram[bucket] = offset;
+			offset += bucketCount;
+		}
+		for (size_t i = 0; i < count; i++) {
+			scratch[histogram[(order[i].key >> shift) & 0xFF]++] = order[i];
+		}
+		order.swap(scratch);
+	}
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <GL\glew.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include "GeometryRegistry.h"
+#include "Material.h"
+
+#ifndef  RenderQueue_h
+#define RenderQueue_h
+
+class Shader; // defined in Main.cpp
+
+// one draw call, filled in by the object (MakeDrawPacket) and the queue (Submit), only points at object data
+struct DrawPacket {
+	unsigned long long key; // sort key, see RenderQueue::MakeSortKey
+	const Shader* shader; // program the packet is drawn with
+	GLuint texture; // diffuse texture
+	GLenum textureTarget; // GL_TEXTURE_2D on unit 0 or GL_TEXTURE_2D_ARRAY on unit 1, the layer is part of the material
+	const Geometry* geometry; // shared VAO/VBO, nullptr for procedural primitives
+	PrimitiveType primitive; // primitive type for the procedural path
+	int segments[2]; // tessellation of the active LOD level for the procedural path
+	const glm::mat4* transform; // model matrix of the object
+	unsigned int transformIndex; // MVP and normal matrix of the object in the frame's TransformBatch, set by SubmitDrawPacket
+	const Material* material; // material of the object
+};
+
+// position of a packet in the sorted draw order
+struct SortEntry {
+	unsigned long long key;
+	unsigned int packet; // index into RenderQueue::packets
+};
+
+// collects the draw packets of a frame and orders them so that consecutive draws share as much state as possible
+class RenderQueue {
+public:
+	std::vector<DrawPacket> packets; // submitted this frame, in submission order
+	std::vector<SortEntry> order; // packets sorted by key, valid after Sort
+	float depthRange; // view distance mapped onto the depth bits of the key (the far plane)
+	RenderQueue(float depthRange);
+	void Clear(); // empties the queue, keeps the memory for the next frame
+	void Submit(DrawPacket packet, const Shader* shader, GLuint program, glm::vec3 cameraPosition); // adds a packet keyed by its distance to the camera
+	unsigned long long MakeSortKey(GLuint program, GLuint texture, GLuint vao, float depth) const;
+	void Sort(); // LSD radix sort of the keys into order
+private:
+	std::vector<SortEntry> scratch; // second buffer of the radix sort
+};
+
+#endif /RenderQueue_h/
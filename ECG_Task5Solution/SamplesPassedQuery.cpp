@@ -0,0 +1,48 @@
+#include "SamplesPassedQuery.h"
+
+SamplesPassedQuery::SamplesPassedQuery() {
+	glGenQueries(2, queries);
+	pending[0] = false;
+	pending[1] = false;
+	current = 0;
+	active = false;
+	samples = 0;
+}
+
+void SamplesPassedQuery::Begin() {
+	if (pending[current]) { // still running from two frames ago, skip this frame instead of waiting
+		GLuint available = GL_FALSE;
+		glGetQueryObjectuiv(queries[current], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (available == GL_FALSE) {
+			return;
+		}
+		glGetQueryObjectui64v(queries[current], GL_QUERY_RESULT, &samples);
+		pending[current] = false;
+	}
+	glBeginQuery(GL_SAMPLES_PASSED, queries[current]);
+	pending[current] = true;
+	active = true;
+}
+
+void SamplesPassedQuery::End() {
+	if (!active) {
+		return; // Begin skipped this frame
+	}
+	glEndQuery(GL_SAMPLES_PASSED);
+	active = false;
+	current = 1 - current;
+
+	// the other query was issued last frame and is usually done by now
+	if (pending[current]) {
+		GLuint available = GL_FALSE;
+		glGetQueryObjectuiv(queries[current], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (available == GL_TRUE) {
+			glGetQueryObjectui64v(queries[current], GL_QUERY_RESULT, &samples);
+			pending[current] = false;
+		}
+	}
+}
+
+void SamplesPassedQuery::Release() {
+	glDeleteQueries(2, queries);
+}
@@ -0,0 +1,23 @@
+#pragma once
+#include <GL\glew.h>
+
+#ifndef  SamplesPassedQuery_h
+#define SamplesPassedQuery_h
+
+// GL_SAMPLES_PASSED of one pass per frame. Two queries alternate and a result is only read once it is
+// available, so the count lags a frame or two behind but never makes the CPU wait for the GPU
+class SamplesPassedQuery {
+public:
+	GLuint64 samples; // samples that passed the depth test in the last finished pass
+	SamplesPassedQuery(); // needs a current GL context
+	void Begin();
+	void End();
+	void Release();
+private:
+	GLuint queries[2];
+	bool pending[2]; // issued and not read yet
+	int current;
+	bool active; // between a Begin that issued a query and its End
+};
+
+#endif /SamplesPassedQuery_h/
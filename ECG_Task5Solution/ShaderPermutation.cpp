@@ -0,0 +1,156 @@
+#include "ShaderPermutation.h"
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <map>
+#include <vector>
+#include "ProgramBinaryCache.h"
+
+const int kMaxIncludeDepth = 8; // chunks including chunks, anything deeper is an include cycle
+
+static const char* const featureDefines[kShaderFeatureCount] = { // bit i of the feature mask
+	"TEXTURED",
+	"POINT_LIGHTS",
+	"DIRECTIONAL_LIGHT",
+	"GOURAUD",
+	"MULTI_DRAW",
+	"DEPTH_ONLY",
+	"GBUFFER"
+};
+
+// the variant a program was built for
+struct ShaderVariantKey {
+	std::string vertexPath;
+	std::string fragmentPath;
+	unsigned int features;
+	bool operator<(const ShaderVariantKey& other) const {
+		if (features != other.features) return features < other.features;
+		if (vertexPath != other.vertexPath) return vertexPath < other.vertexPath;
+		return fragmentPath < other.fragmentPath;
+	}
+};
+
+static std::map<ShaderVariantKey, GLuint> variants; // all built programs
+
+static std::string ExpandIncludes(const std::string& relativePath, int depth) {
+	std::ifstream is(relativePath); // read shader file
+	if (!is) {
+		std::cerr << "ERROR: shader source " << relativePath << " not found\n";
+		return "";
+	}
+	std::string directory = relativePath.substr(0, relativePath.find_last_of("/\\") + 1); // chunks live next to the including file
+
+	std::string source;
+	std::string line;
+	while (std::getline(is, line)) {
+		size_t start = line.find_first_not_of(" \t");
+		if (start != std::string::npos && line.compare(start, 10, "#include \"") == 0) {
+			size_t nameStart = start + 10;
+			size_t nameEnd = line.find('"', nameStart);
+			if (depth >= kMaxIncludeDepth || nameEnd == std::string::npos) {
+				std::cerr << "ERROR: " << relativePath << ": bad or cyclic " << line << "\n";
+				continue;
+			}
+			source += ExpandIncludes(directory + line.substr(nameStart, nameEnd - nameStart), depth + 1);
+			continue;
+		}
+		source += line;
+		source += '\n';
+	}
+	return source;
+}
+
+std::string AssembleShaderSource(const std::string& relativePath, unsigned int features) {
+	std::string source = ExpandIncludes(relativePath, 0);
+
+	std::string defines;
+	for (int i = 0; i < kShaderFeatureCount; i++) {
+		if (features & (1u << i)) {
+			defines += "#define ";
+			defines += featureDefines[i];
+			defines += '\n';
+		}
+	}
+
+	size_t version = source.find("#version");
+	size_t insert = version == std::string::npos ? 0 : source.find('\n', version) + 1; // #version has to stay the first directive
+	source.insert(insert, defines);
+	return source;
+}
+
+static GLuint CompileStage(GLenum stage, const std::string& assembled, const std::string& relativePath, unsigned int features) {
+	const char* source = assembled.c_str();
+	GLuint shader = glCreateShader(stage);
+	glShaderSource(shader, 1, &source, 0);
+	glCompileShader(shader);
+
+	GLint succeded;
+	glGetShaderiv(shader, GL_COMPILE_STATUS, &succeded);
+	if (succeded == GL_FALSE) {
+		GLint logSize;
+		glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &logSize);
+		GLchar* message = new char[logSize];
+		glGetShaderInfoLog(shader, logSize, NULL, message);
+		std::cerr << relativePath << " (features " << features << "): " << message;
+		delete[] message;
+	}
+	return shader;
+}
+
+GLuint AcquireShaderProgram(const std::string& vertexPath, const std::string& fragmentPath, unsigned int features) {
+	ShaderVariantKey key;
+	key.vertexPath = vertexPath;
+	key.fragmentPath = fragmentPath;
+	key.features = features;
+	std::map<ShaderVariantKey, GLuint>::iterator it = variants.find(key);
+	if (it != variants.end()) { // already built, share it
+		return it->second;
+	}
+
+	std::vector<std::string> sources(2);
+	sources[0] = AssembleShaderSource(vertexPath, features);
+	sources[1] = AssembleShaderSource(fragmentPath, features);
+	unsigned long long cacheKey = ProgramCacheKey(sources);
+	GLuint program = LoadProgramBinary(cacheKey); // linked by an earlier run with the same sources and driver
+	if (program != 0) {
+		variants[key] = program;
+		return program;
+	}
+
+	GLuint vertexShader = CompileStage(GL_VERTEX_SHADER, sources[0], vertexPath, features);
+	GLuint fragmentShader = CompileStage(GL_FRAGMENT_SHADER, sources[1], fragmentPath, features);
+	program = glCreateProgram();
+	glAttachShader(program, vertexShader);
+	glAttachShader(program, fragmentShader);
+	MarkProgramRetrievable(program);
+	glLinkProgram(program);
+	glDeleteShader(vertexShader); // stay alive while attached
+	glDeleteShader(fragmentShader);
+
+	GLint isLinked;
+	glGetProgramiv(program, GL_LINK_STATUS, &isLinked);
+	if (isLinked == GL_FALSE) {
+		GLint maxLength;
+		glGetProgramiv(program, GL_INFO_LOG_LENGTH, &maxLength);
+		GLchar* message = new char[maxLength];
+		glGetProgramInfoLog(program, maxLength, &maxLength, message);
+		std::cerr << vertexPath << " + " << fragmentPath << " (features " << features << "): " << message;
+		delete[] message;
+	}
+	StoreProgramBinary(program, cacheKey); // only if it linked
+
+	variants[key] = program;
+	return program;
+}
+
+void ReleaseShaderPrograms() {
+	for (std::map<ShaderVariantKey, GLuint>::iterator it = variants.begin(); it != variants.end(); ++it) {
+		glDeleteProgram(it->second);
+	}
+	variants.clear();
+}
+
+size_t ShaderVariantCount() {
+	return variants.size();
+}
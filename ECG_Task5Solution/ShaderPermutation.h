@@ -0,0 +1,38 @@
+#pragma once
+#include <GL\glew.h>
+#include <string>
+#include <cstddef>
+
+#ifndef  ShaderPermutation_h
+#define ShaderPermutation_h
+
+// feature flags of a shader variant, each set bit becomes a #define of the same name without the prefix
+enum ShaderFeature {
+	SHADER_TEXTURED = 1 << 0, // colorTexture/colorTextureArray modulate the material color
+	SHADER_POINT_LIGHTS = 1 << 1, // the clustered point lights of ClusteredLights
+	SHADER_DIRECTIONAL_LIGHT = 1 << 2,
+	SHADER_GOURAUD = 1 << 3, // lit per vertex instead of per fragment
+	SHADER_MULTI_DRAW = 1 << 4, // material from the ObjectBuffer entry instead of uniforms
+	SHADER_DEPTH_ONLY = 1 << 5, // no color output, the depth pre-pass
+	SHADER_GBUFFER = 1 << 6 // surface data for the deferred path instead of lit color
+};
+
+const int kShaderFeatureCount = 7;
+const unsigned int kPhongFeatures = SHADER_TEXTURED | SHADER_POINT_LIGHTS | SHADER_DIRECTIONAL_LIGHT; // the forward lit surfaces
+
+// source of the shader at "relativePath" with every #include "chunk" line replaced by the chunk (looked up next to the
+// including file, chunks guard themselves against double inclusion) and the #defines of "features" after #version
+std::string AssembleShaderSource(const std::string& relativePath, unsigned int features);
+
+// program of the vertex and fragment shader at the given paths, compiled for "features". Every combination is
+// built once and shared by all callers, from the program binary cache if it holds the assembled sources
+// (see ProgramBinaryCache.h), else compiled and linked, compile and link errors go to std::cerr
+GLuint AcquireShaderProgram(const std::string& vertexPath, const std::string& fragmentPath, unsigned int features);
+
+// deletes every program built by AcquireShaderProgram
+void ReleaseShaderPrograms();
+
+// number of distinct variants currently built
+size_t ShaderVariantCount();
+
+#endif /ShaderPermutation_h/
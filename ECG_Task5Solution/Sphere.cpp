@@ -1,27 +1,86 @@
 #include "Sphere.h"
+#include "ParametricMeshGenerator.h"
+#include "VertexBufferWriter.h"
 
-Sphere::Sphere(glm::mat4 _transform, float radius, float r, float g, float b, float ka, float kd, float ks, glm::vec3 position, int horizontalSegments, int verticalSegments, int alpha) {
-	mesh = SphereMesh(radius, horizontalSegments, verticalSegments);
+// shared unit sphere geometry of a tessellation, "cpuCopy" is uploaded instead of generating a new mesh if given
+static Geometry* AcquireSphereGeometry(int horizontalSegments, int verticalSegments, bool indexed, bool packed, const SphereMesh* cpuCopy) {
+	GeometryKey key(PRIMITIVE_SPHERE, 1.0f, 0.0f, 0.0f, horizontalSegments, verticalSegments, indexed, packed);
+	return AcquireGeometry(key, [&](Geometry& shared) { // only built for the first sphere of this kind
+		if (!indexed && !packed && cpuCopy == nullptr) {
+			// plain float triangle list: generate it straight into the mapped VBO, no CPU side copy
+			size_t floatCount = SphereMeshFloatCount(horizontalSegments, verticalSegments);
+			WriteVertexBuffer(floatCount, [&](float* out) {
+				GenerateSphereMesh(1.0f, horizontalSegments, verticalSegments, out);
+			});
+			SetVertexLayout(false);
+			shared.bounds = SphereMeshBounds(1.0f);
+			shared.elementCount = (GLsizei)(floatCount / 8);
+			return;
+		}
+
+		SphereMesh temporary;
+		const SphereMesh* source = cpuCopy;
+		if (source == nullptr) {
+			temporary = SphereMesh(1.0f, horizontalSegments, verticalSegments, indexed); // released again once uploaded
+			source = &temporary;
+		}
+		UploadMeshGeometry(shared, source->data, source->vertices, source->indices, source->indexed, source->shortIndices, packed);
+	});
+}
+
+Sphere::Sphere(glm::mat4 _transform, float _radius, float r, float g, float b, float ka, float kd, float ks, glm::vec3 position, int _horizontalSegments, int _verticalSegments, int alpha, bool indexed, bool packed, bool keepCpuCopy, int lodLevels, bool procedural) {
 	material = Material(r, g, b, ka, kd, ks, alpha);
 	position = position;
 	texture = Texture("assets/textures/tiles_diffuse.dds");
-	transform = glm::translate(_transform, position);
-
-	glGenVertexArrays(1, &Vao); // create the VAO
-	glBindVertexArray(Vao); // bind the VAO
+	material.textureLayer = texture.layer; // -1 unless the texture was packed into an array
+	radius = _radius;
+	transform = glm::scale(glm::translate(_transform, position), glm::vec3(radius)); // the mesh is a unit sphere
+	horizontalSegments = _horizontalSegments;
+	verticalSegments = _verticalSegments;
 
-	glGenBuffers(1, &Vbo); // generate the VBO
-	glBindBuffer(GL_ARRAY_BUFFER, Vbo); // bind the VBO
-	glBufferData(GL_ARRAY_BUFFER, mesh.data.size() * sizeof(float), &mesh.data[0], GL_STATIC_DRAW);
+	if (keepCpuCopy) {
+		mesh = SphereMesh(1.0f, horizontalSegments, verticalSegments, indexed); // kept for picking or physics, finest level only, unit radius
+	}
 
-	glEnableVertexAttribArray(0); // set position attribute vertex layout  1/2
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), 0); // set vertex layout 2/2
+	// level 0 is the requested tessellation, every further level halves both segment counts
+	int latitude = horizontalSegments;
+	int longitude = verticalSegments;
+	for (int level = 0; level < lodLevels; level++) {
+		if (level > 0 && (latitude / 2 < 3 || longitude / 2 < 4)) {
+			break; // any coarser and it stops looking like a sphere
+		}
+		if (level > 0) {
+			latitude /= 2;
+			longitude /= 2;
+		}
+		if (procedural) {
+			lod.AddLevel(nullptr, longitude); // built by ProceduralShader.vert at draw time, nothing to upload
+			continue;
+		}
+		lod.AddLevel(AcquireSphereGeometry(latitude, longitude, indexed, packed, level == 0 && keepCpuCopy ? &mesh : nullptr), longitude);
+	}
+	geometry = lod.levels[0].geometry;
+	bounds = geometry != nullptr ? geometry->bounds : SphereMeshBounds(1.0f); // procedural spheres have no vertex data
+}
 
-	glEnableVertexAttribArray(1); // set color attribute vertex layout 1/2
-	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
+void Sphere::UpdateLod(const glm::mat4& projection, glm::vec3 cameraPosition, int viewportHeight) {
+	glm::vec3 center = glm::vec3(transform[3]); // world space translation of the sphere
+	geometry = lod.Select(ProjectedScreenRadius(projection, cameraPosition, center, radius, viewportHeight));
+}
 
-	glEnableVertexAttribArray(2); // set color attribute vertex layout 1/2
-	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
+DrawPacket Sphere::MakeDrawPacket() const {
+	DrawPacket packet = DrawPacket();
+	packet.texture = texture.Handle();
+	packet.textureTarget = texture.target;
+	packet.geometry = geometry;
+	packet.primitive = PRIMITIVE_SPHERE;
+	packet.segments[0] = horizontalSegments >> lod.current; // every level halves the segment counts
+	packet.segments[1] = verticalSegments >> lod.current;
+	packet.transform = &transform;
+	packet.material = &material;
+	return packet;
+}
 
-	glEnableVertexAttribArray(0); // disable the VAO
+BoundingVolume Sphere::WorldBounds() const {
+	return TransformBounds(bounds, transform);
 }
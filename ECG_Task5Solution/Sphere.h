@@ -4,6 +4,10 @@
 #include <GL\glew.h>
 #include "Material.h"
 #include "Texture.h"
+#include "GeometryRegistry.h"
+#include "LevelOfDetail.h"
+#include "RenderQueue.h"
+#include "BoundingVolume.h"
 
 
 #ifndef  Sphere_h
@@ -11,15 +15,21 @@
 
 class Sphere {
 public:
-	SphereMesh mesh; // mesh of the cylinder
-	glm::mat4 transform; // transform of the cylinder
-	GLuint Vao; // vertex array object
-	GLuint Vbo; // vertex buffer object
-	GLuint Ebo; // element buffer object
+	SphereMesh mesh; // CPU side mesh of the sphere, empty unless keepCpuCopy was requested
+	glm::mat4 transform; // transform of the sphere, scales the unit sphere to its radius
+	Geometry* geometry; // unit sphere VAO/VBO shared with every sphere of the same tessellation, the active LOD level
+	LodChain lod; // tessellation levels, finest first
+	float radius; // radius of the sphere, also its bounding radius for LOD selection
+	BoundingVolume bounds; // object space bounds of the unit mesh
+	int horizontalSegments; // latitude segments of the finest level, halved per level
+	int verticalSegments; // longitude segments of the finest level, halved per level
 	Material material;
 	Texture texture;
 	glm::vec3 position;
-	Sphere::Sphere(glm::mat4 transform, float radius, float r, float g, float b, float ka, float kd, float ks, glm::vec3 position, int horizontalSegments, int verticalSegments, int alpha); // cylinder constructor
+	Sphere::Sphere(glm::mat4 transform, float radius, float r, float g, float b, float ka, float kd, float ks, glm::vec3 position, int horizontalSegments, int verticalSegments, int alpha, bool indexed = false, bool packed = false, bool keepCpuCopy = false, int lodLevels = 1, bool procedural = false); // sphere constructor
+	void UpdateLod(const glm::mat4& projection, glm::vec3 cameraPosition, int viewportHeight); // picks the level for the current view
+	DrawPacket MakeDrawPacket() const; // draw packet of the active LOD level
+	BoundingVolume WorldBounds() const; // bounds transformed by transform
 };
 
 #endif /Sphere_h/
\ No newline at end of file
@@ -2,6 +2,7 @@
 #include <glm\detail\type_mat.hpp>
 #include <glm/glm.hpp>
 #include <vector>
+#include "BoundingVolume.h"
 #include <glm\gtc\constants.hpp>
 
 #ifndef  SphereMesh_h
@@ -9,9 +10,15 @@
 
 class SphereMesh {
 public:
-	std::vector<float> data; // dynamic vertices array
+	std::vector<float> data; // dynamic vertices array, 3 vertices per triangle (empty if indexed)
+	std::vector<float> vertices; // unique vertices array (indexed mode only)
+	std::vector<unsigned int> indices; // triangle indices into vertices (indexed mode only)
+	bool indexed; // true if the mesh is stored as vertices + indices instead of data
+	bool shortIndices; // true if the indices fit into a 16 bit index buffer
+	BoundingVolume bounds; // of the generated vertices, kept after ReleaseCpuData
+	void ReleaseCpuData(); // frees data, vertices and indices once they live on the GPU
 	SphereMesh(); // default constructor
-	SphereMesh(float radius, float latitudeSegments, float longitudeSegments); // cylinder mesh  constructor
+	SphereMesh(float radius, float latitudeSegments, float longitudeSegments, bool indexed = false); // sphere mesh constructor
 };
 
 #endif /SphereMesh_h/
\ No newline at end of file
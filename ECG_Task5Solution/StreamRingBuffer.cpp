@@ -0,0 +1,107 @@
+#include "StreamRingBuffer.h"
+
+StreamRingBuffer::StreamRingBuffer(GLsizeiptr _segmentSize) {
+	glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uniformAlignment);
+	glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &storageAlignment);
+	GLsizeiptr segmentAlignment = uniformAlignment > storageAlignment ? uniformAlignment : storageAlignment;
+	segmentSize = (_segmentSize + segmentAlignment - 1) / segmentAlignment * segmentAlignment; // every segment starts aligned
+	GLsizeiptr size = segmentSize * kStreamSegments;
+
+	glGenBuffers(1, &Buffer);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, Buffer); // any target works, the buffer is bound by range later
+	mapped = nullptr;
+	persistent = GLEW_ARB_buffer_storage != 0;
+	if (persistent) {
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glBufferStorage(GL_COPY_WRITE_BUFFER, size, nullptr, flags);
+		mapped = (unsigned char*)glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, size, flags); // stays mapped for the lifetime of the buffer
+		persistent = mapped != nullptr;
+	}
+	if (!persistent) {
+		mapped = nullptr; // Allocate fails from now on, callers take their glBufferData/glBufferSubData path
+	}
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+	for (int i = 0; i < kStreamSegments; i++) {
+		fences[i] = 0;
+	}
+	segment = 0;
+	head = 0;
+	fenceWaits = 0;
+	failedAllocations = 0;
+}
+
+void StreamRingBuffer::BeginFrame() {
+	segment = (segment + 1) % kStreamSegments;
+	head = 0;
+	if (fences[segment] == 0) {
+		return;
+	}
+
+	GLenum status = glClientWaitSync(fences[segment], 0, 0); // poll first, this is the normal case
+	if (status == GL_TIMEOUT_EXPIRED) {
+		fenceWaits++;
+		while (status == GL_TIMEOUT_EXPIRED) { // the GPU is kStreamSegments frames behind, block until it releases the segment
+			status = glClientWaitSync(fences[segment], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000); // 1 ms
+		}
+	}
+	glDeleteSync(fences[segment]);
+	fences[segment] = 0;
+}
+
+StreamAllocation StreamRingBuffer::Allocate(GLsizeiptr size, GLsizeiptr alignment) {
+	StreamAllocation allocation;
+	GLsizeiptr start = (head + alignment - 1) / alignment * alignment; // segments start aligned, so the offset inside is enough
+	if (!persistent || start + size > segmentSize) {
+		failedAllocations += persistent ? 1 : 0;
+		allocation.data = nullptr;
+		allocation.offset = 0;
+		allocation.size = 0;
+		return allocation;
+	}
+
+	allocation.offset = segment * segmentSize + start;
+	allocation.data = mapped + allocation.offset;
+	allocation.size = size;
+	head = start + size;
+	return allocation;
+}
+
+StreamAllocation StreamRingBuffer::AllocateUniforms(GLsizeiptr size) {
+	return Allocate(size, uniformAlignment);
+}
+
+StreamAllocation StreamRingBuffer::AllocateStorage(GLsizeiptr size) {
+	return Allocate(size, storageAlignment);
+}
+
+StreamAllocation StreamRingBuffer::AllocateInstances(GLsizeiptr size) {
+	return Allocate(size, 16);
+}
+
+StreamAllocation StreamRingBuffer::AllocateIndirect(GLsizeiptr size) {
+	return Allocate(size, 4); // commands are arrays of GLuint
+}
+
+void StreamRingBuffer::EndFrame() {
+	if (!persistent) {
+		return; // nothing was written to the ring
+	}
+	fences[segment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0); // signaled once every draw of this frame read its data
+}
+
+void StreamRingBuffer::Release() {
+	for (int i = 0; i < kStreamSegments; i++) {
+		if (fences[i] != 0) {
+			glDeleteSync(fences[i]);
+			fences[i] = 0;
+		}
+	}
+	if (persistent) {
+		glBindBuffer(GL_COPY_WRITE_BUFFER, Buffer);
+		glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	}
+	mapped = nullptr;
+	glDeleteBuffers(1, &Buffer);
+}
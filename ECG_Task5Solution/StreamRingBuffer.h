@@ -0,0 +1,45 @@
+#pragma once
+#include <GL\glew.h>
+
+#ifndef  StreamRingBuffer_h
+#define StreamRingBuffer_h
+
+const int kStreamSegments = 3; // frames in flight: the CPU writes one segment while the GPU may still read the other two
+
+// piece of the current frame segment, "data" is write-only CPU memory and "offset" the matching position in the buffer
+struct StreamAllocation {
+	void* data; // nullptr if the segment is full or the buffer could not be mapped persistently
+	GLintptr offset;
+	GLsizeiptr size;
+};
+
+// one buffer object split into kStreamSegments frame segments. With ARB_buffer_storage it is mapped once,
+// persistent and coherent, and each segment is fenced when its frame is submitted, so writing frame N+1 never waits
+// for the GPU unless it is kStreamSegments frames behind. Without a persistent mapping every allocation fails and
+// the callers upload through their own orphaned buffers, the data has to be on the GPU before the draws that bind it
+class StreamRingBuffer {
+public:
+	GLuint Buffer; // bind ranges of it with the offsets of the allocations
+	GLsizeiptr segmentSize; // bytes per frame
+	bool persistent; // mapped with GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT, the ring is unused otherwise
+	unsigned int fenceWaits; // frames BeginFrame had to block on the fence of the segment it reuses
+	unsigned int failedAllocations; // allocations that did not fit into their segment (not counted without a persistent mapping)
+	StreamRingBuffer(GLsizeiptr segmentSize); // creates and maps the buffer, needs a current GL context
+	void BeginFrame(); // moves to the next segment, waiting for the GPU if it still reads it
+	StreamAllocation AllocateUniforms(GLsizeiptr size); // aligned for glBindBufferRange(GL_UNIFORM_BUFFER)
+	StreamAllocation AllocateStorage(GLsizeiptr size); // aligned for glBindBufferRange(GL_SHADER_STORAGE_BUFFER)
+	StreamAllocation AllocateInstances(GLsizeiptr size); // vertex attribute data, 16 byte aligned
+	StreamAllocation AllocateIndirect(GLsizeiptr size); // draw commands for GL_DRAW_INDIRECT_BUFFER
+	void EndFrame(); // fences the segment of this frame, call after the last draw reading it
+	void Release(); // unmaps and deletes the buffer
+private:
+	unsigned char* mapped; // persistent mapping of the whole buffer, nullptr without one
+	GLsync fences[kStreamSegments]; // one per segment, 0 until the segment was used once
+	int segment; // segment of the current frame
+	GLsizeiptr head; // bytes used in the current segment
+	GLint uniformAlignment;
+	GLint storageAlignment;
+	StreamAllocation Allocate(GLsizeiptr size, GLsizeiptr alignment);
+};
+
+#endif /StreamRingBuffer_h/
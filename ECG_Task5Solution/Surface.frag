@@ -0,0 +1,98 @@
+//fragment shader of every opaque surface, AssembleShaderSource defines the features of the variant (ShaderFeature in ShaderPermutation.h):
+//TEXTURED, POINT_LIGHTS, DIRECTIONAL_LIGHT, GOURAUD (lit per vertex in PhongShader.vert), MULTI_DRAW (material of the
+//ObjectBuffer entry instead of uniforms), DEPTH_ONLY (the pre-pass) and GBUFFER (surface data for the deferred path)
+#version 430
+
+#include "FrameData.glsl"
+
+#ifdef DEPTH_ONLY
+
+void main()
+{
+}
+
+#else
+
+#ifdef MULTI_DRAW
+#include "ObjectData.glsl"
+#endif
+#ifdef POINT_LIGHTS
+#include "ClusteredLights.glsl"
+#endif
+#include "PhongLighting.glsl"
+#include "Octahedral.glsl"
+
+#ifdef GBUFFER
+layout (location = 0) out vec4 Albedo; // RGBA8, texture color * material color
+layout (location = 1) out vec2 NormalOctahedral; // RG8/RG16/RG16F (gbuffer_normals), octahedral world normal mapped to [0, 1]
+layout (location = 2) out vec4 Material; // RGBA8, k_ambient, k_diffuse, k_specular, alpha / 255
+#else
+out vec4 FragColor;
+#endif
+
+in vec3 Normal;
+in vec3 FragPos;
+in vec2 Uv;
+#ifdef GOURAUD
+in vec3 LightingColor; // resulting color from the lighting in the vertex shader
+#endif
+#ifdef MULTI_DRAW
+flat in int ObjectIndex;
+#else
+uniform vec3 materialColor;
+
+uniform float k_ambient;
+uniform float k_diffuse;
+uniform float k_specular;
+
+uniform int alpha;
+
+uniform int textureLayer = -1; // layer of the material texture in colorTextureArray
+#endif
+
+#ifdef TEXTURED
+uniform sampler2D colorTexture; // unit 0
+uniform sampler2DArray colorTextureArray; // unit 1, used when the material has a texture layer
+#endif
+
+void main()
+{
+#ifdef MULTI_DRAW
+    vec3 materialColor = objects[ObjectIndex].materialColor.rgb;
+    float k_ambient = objects[ObjectIndex].k_ambient;
+    float k_diffuse = objects[ObjectIndex].k_diffuse;
+    float k_specular = objects[ObjectIndex].k_specular;
+    int alpha = objects[ObjectIndex].alpha;
+    int textureLayer = objects[ObjectIndex].textureLayer;
+#endif
+
+    vec3 surfaceColor = materialColor;
+#ifdef TEXTURED
+    surfaceColor *= textureLayer >= 0 ? texture(colorTextureArray, vec3(Uv, textureLayer)).rgb : texture(colorTexture, Uv).rgb;
+#endif
+
+#if defined(GBUFFER)
+    Albedo = vec4(surfaceColor, 1.0);
+    NormalOctahedral = EncodeOctahedral(normalize(Normal)) * 0.5 + 0.5;
+    Material = vec4(k_ambient, k_diffuse, k_specular, float(alpha) / 255.0);
+#elif defined(GOURAUD)
+    FragColor = vec4(LightingColor * surfaceColor, 1.0);
+#else
+    vec3 norm = normalize(Normal);
+    vec3 viewDir = normalize(viewPos - FragPos);
+    vec3 result = vec3(0.0);
+
+#ifdef POINT_LIGHTS
+    // only the lights binned into the froxel of this fragment, w of the fragment is 1 / view depth
+    uint cluster = ClusterIndex(gl_FragCoord.xy * clusterScale.xy, 1.0 / gl_FragCoord.w);
+    result += ClusteredPointLights(cluster, FragPos, norm, viewDir, k_ambient, k_diffuse, k_specular, float(alpha));
+#endif
+#ifdef DIRECTIONAL_LIGHT
+    result += PhongLight(norm, normalize(-dLightDirection), viewDir, dLightColor, k_ambient, k_diffuse, k_specular, 10.0);
+#endif
+
+    FragColor = vec4(result * surfaceColor, 1.0);
+#endif
+}
+
+#endif
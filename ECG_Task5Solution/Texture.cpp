@@ -1,12 +1,28 @@
 #include "Texture.h"
+#include "GLStateCache.h"
 
 Texture::Texture() {
-
+	handle = 0;
+	target = GL_TEXTURE_2D;
+	array = nullptr;
+	layer = -1;
 };
 
 Texture::Texture(std::string relativeFilePath) {
+	handle = 0;
+	target = GL_TEXTURE_2D;
+	array = nullptr;
+	layer = -1;
+	if (TextureArrayMode()) { // shares the array handle with every texture of the same size and format
+		TextureLayer arrayLayer = AcquireTextureLayer(relativeFilePath);
+		target = GL_TEXTURE_2D_ARRAY;
+		array = arrayLayer.array;
+		layer = arrayLayer.layer;
+		return;
+	}
+
 	glGenTextures(1, &handle);
-	glBindTexture(GL_TEXTURE_2D, handle);
+	CachedBindTexture(0, GL_TEXTURE_2D, handle);
 	DDSImage img = loadDDS(relativeFilePath.c_str());
 	glCompressedTexImage2D(
 		GL_TEXTURE_2D,
@@ -26,3 +42,7 @@ Texture::Texture(std::string relativeFilePath) {
 Texture::~Texture() {
 
 }
+
+GLuint Texture::Handle() const {
+	return array != nullptr ? array->handle : handle;
+}
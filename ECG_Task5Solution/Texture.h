@@ -4,11 +4,16 @@
 #include <GL\glew.h>
 #include <string>
 #include "Utils.h"
+#include "TextureArray.h"
 class Texture {
 public:
-	GLuint handle;
+	GLuint handle; // own GL_TEXTURE_2D, 0 in texture array mode
+	GLenum target; // GL_TEXTURE_2D or GL_TEXTURE_2D_ARRAY
+	TextureArray* array; // array holding the texture in texture array mode
+	int layer; // layer inside "array", -1 for a GL_TEXTURE_2D
 	Texture::Texture();
-	Texture::Texture(std::string relativeFilePath);
+	Texture::Texture(std::string relativeFilePath); // packs the file into a texture array when TextureArrayMode() is on
 	Texture::~Texture();
+	GLuint Texture::Handle() const; // texture object to bind to "target"
 };
 #endif /Texture_h/
\ No newline at end of file
@@ -0,0 +1,103 @@
+#include "TextureArray.h"
+#include <map>
+#include <vector>
+#include "GLStateCache.h"
+
+static bool arrayMode = false;
+static std::vector<TextureArray*> arrays; // one per size and format
+static std::map<std::string, TextureLayer> loadedFiles; // every file already packed
+
+TextureArray::TextureArray() {
+	handle = 0;
+	format = GL_NONE;
+	width = 0;
+	height = 0;
+	levels = 1;
+	layers = 0;
+	capacity = 0;
+}
+
+TextureLayer::TextureLayer() {
+	array = nullptr;
+	layer = -1;
+}
+
+void SetTextureArrayMode(bool enabled) {
+	arrayMode = enabled;
+}
+
+bool TextureArrayMode() {
+	return arrayMode;
+}
+
+// allocates "capacity" layers for "array" and copies the layers in use from the previous storage
+static void GrowTextureArray(TextureArray& array, GLsizei capacity) {
+	GLuint grown;
+	glGenTextures(1, &grown);
+	CachedBindTexture(0, GL_TEXTURE_2D_ARRAY, grown);
+	glTexStorage3D(GL_TEXTURE_2D_ARRAY, array.levels, array.format, array.width, array.height, capacity);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	if (array.handle != 0) {
+		for (GLsizei level = 0; level < array.levels; level++) { // every mip level of the old layers, compressed blocks are copied as they are
+			GLsizei levelWidth = array.width >> level > 0 ? array.width >> level : 1;
+			GLsizei levelHeight = array.height >> level > 0 ? array.height >> level : 1;
+			glCopyImageSubData(array.handle, GL_TEXTURE_2D_ARRAY, level, 0, 0, 0, grown, GL_TEXTURE_2D_ARRAY, level, 0, 0, 0, levelWidth, levelHeight, array.layers);
+		}
+		CachedDeleteTexture(array.handle);
+	}
+	array.handle = grown;
+	array.capacity = capacity;
+}
+
+TextureLayer AcquireTextureLayer(const std::string& relativeFilePath) {
+	std::map<std::string, TextureLayer>::iterator it = loadedFiles.find(relativeFilePath);
+	if (it != loadedFiles.end()) { // already packed, share the layer
+		return it->second;
+	}
+
+	DDSImage img = loadDDS(relativeFilePath.c_str());
+
+	TextureArray* array = nullptr;
+	for (size_t i = 0; i < arrays.size(); i++) {
+		if (arrays[i]->width == img.width && arrays[i]->height == img.height && arrays[i]->format == img.format) {
+			array = arrays[i];
+			break;
+		}
+	}
+	if (array == nullptr) { // first texture of this size and format
+		array = new TextureArray();
+		array->format = img.format;
+		array->width = img.width;
+		array->height = img.height;
+		unsigned int largest = img.width > img.height ? img.width : img.height;
+		while (largest >> array->levels > 0) {
+			array->levels++;
+		}
+		arrays.push_back(array);
+	}
+	if (array->layers == array->capacity) {
+		GrowTextureArray(*array, array->capacity > 0 ? array->capacity * 2 : 1);
+	}
+
+	TextureLayer layer;
+	layer.array = array;
+	layer.layer = array->layers++;
+
+	CachedBindTexture(0, GL_TEXTURE_2D_ARRAY, array->handle);
+	glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer.layer, img.width, img.height, 1, img.format, img.size, img.data);
+	glGenerateMipmap(GL_TEXTURE_2D_ARRAY); // like Texture, the chain is built from level 0
+
+	loadedFiles[relativeFilePath] = layer;
+	return layer;
+}
+
+void ReleaseTextureArrays() {
+	for (size_t i = 0; i < arrays.size(); i++) {
+		CachedDeleteTexture(arrays[i]->handle);
+		delete arrays[i];
+	}
+	arrays.clear();
+	loadedFiles.clear();
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include <GL\glew.h>
+#include <string>
+#include "Utils.h"
+
+#ifndef  TextureArray_h
+#define TextureArray_h
+
+// GL_TEXTURE_2D_ARRAY holding every loaded DDS texture of one size and format, one layer per file.
+// Objects whose textures share an array bind the same handle and only differ in the layer index of their material
+class TextureArray {
+public:
+	GLuint handle; // changes when the array grows, read it when building draw packets
+	GLenum format; // compressed internal format of every layer
+	unsigned int width;
+	unsigned int height;
+	GLsizei levels; // full mip chain
+	GLsizei layers; // layers in use
+	GLsizei capacity; // layers allocated
+	TextureArray();
+};
+
+// array and layer a texture file was loaded into
+class TextureLayer {
+public:
+	TextureArray* array;
+	int layer;
+	TextureLayer();
+};
+
+// loader mode: when enabled, Texture(path) packs the file into the texture array of its size and format
+// instead of creating its own GL_TEXTURE_2D
+void SetTextureArrayMode(bool enabled);
+bool TextureArrayMode();
+
+// returns the layer of "relativeFilePath", loading it on first use. The file is shared by every caller,
+// a full array is reallocated with twice the layers and the old ones are copied over on the GPU
+TextureLayer AcquireTextureLayer(const std::string& relativeFilePath);
+
+// deletes every texture array
+void ReleaseTextureArrays();
+
+#endif /TextureArray_h/
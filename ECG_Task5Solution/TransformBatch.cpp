@@ -0,0 +1,149 @@
+#include "TransformBatch.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define TRANSFORM_BATCH_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TRANSFORM_BATCH_SSE2
+#endif
+
+const size_t kTransformStride = sizeof(ObjectTransform) / sizeof(float); // floats from one object to the next
+static_assert(sizeof(ObjectTransform) == 28 * sizeof(float), "ObjectTransform has to be tightly packed floats");
+
+ObjectTransform MakeObjectTransform(const glm::mat4& model, const glm::mat4& viewProjection) {
+	glm::vec3 a0 = glm::vec3(model[0]);
+	glm::vec3 a1 = glm::vec3(model[1]);
+	glm::vec3 a2 = glm::vec3(model[2]);
+	glm::vec3 c0 = glm::cross(a1, a2); // the columns of inverse(mat3(model))^T are these over the determinant
+	glm::vec3 c1 = glm::cross(a2, a0);
+	glm::vec3 c2 = glm::cross(a0, a1);
+	float inverseDeterminant = 1.0f / glm::dot(a0, c0);
+
+	ObjectTransform transform;
+	transform.mvp = viewProjection * model;
+	transform.normalMatrix[0] = glm::vec4(c0 * inverseDeterminant, 0.0f);
+	transform.normalMatrix[1] = glm::vec4(c1 * inverseDeterminant, 0.0f);
+	transform.normalMatrix[2] = glm::vec4(c2 * inverseDeterminant, 0.0f);
+	return transform;
+}
+
+#if defined(TRANSFORM_BATCH_AVX2) || defined(TRANSFORM_BATCH_SSE2)
+// lane k of x, y, z and w are the 4 rows of one column of object k, "first" points at that column of object 0
+static inline void StoreColumn4(__m128 x, __m128 y, __m128 z, __m128 w, float* first) {
+	_MM_TRANSPOSE4_PS(x, y, z, w);
+	_mm_storeu_ps(first, x);
+	_mm_storeu_ps(first + kTransformStride, y);
+	_mm_storeu_ps(first + 2 * kTransformStride, z);
+	_mm_storeu_ps(first + 3 * kTransformStride, w);
+}
+#endif
+
+TransformBatch::TransformBatch() {
+}
+
+void TransformBatch::Clear() {
+	for (int e = 0; e < 16; e++) {
+		elements[e].clear();
+	}
+	transforms.clear();
+}
+
+unsigned int TransformBatch::Add(const glm::mat4& model) {
+	for (int e = 0; e < 16; e++) {
+		elements[e].push_back(model[e / 4][e % 4]);
+	}
+	return (unsigned int)(elements[0].size() - 1);
+}
+
+void TransformBatch::Compute(const glm::mat4& viewProjection) {
+	size_t count = elements[0].size();
+	transforms.resize(count);
+	size_t i = 0;
+
+#if defined(TRANSFORM_BATCH_AVX2)
+	for (; i + 8 <= count; i += 8) {
+		__m256 m[16];
+		for (int e = 0; e < 16; e++) {
+			m[e] = _mm256_loadu_ps(&elements[e][i]);
+		}
+		float* first = &transforms[i].mvp[0][0];
+
+		for (int c = 0; c < 4; c++) { // mvp[c][r] = sum over k of viewProjection[k][r] * model[c][k]
+			__m256 rows[4];
+			for (int r = 0; r < 4; r++) {
+				rows[r] = _mm256_add_ps(
+					_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(viewProjection[0][r]), m[c * 4]), _mm256_mul_ps(_mm256_set1_ps(viewProjection[1][r]), m[c * 4 + 1])),
+					_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(viewProjection[2][r]), m[c * 4 + 2]), _mm256_mul_ps(_mm256_set1_ps(viewProjection[3][r]), m[c * 4 + 3]))); // no FMA, /arch:AVX2 does not imply it everywhere
+			}
+			StoreColumn4(_mm256_castps256_ps128(rows[0]), _mm256_castps256_ps128(rows[1]), _mm256_castps256_ps128(rows[2]), _mm256_castps256_ps128(rows[3]), first + c * 4);
+			StoreColumn4(_mm256_extractf128_ps(rows[0], 1), _mm256_extractf128_ps(rows[1], 1), _mm256_extractf128_ps(rows[2], 1), _mm256_extractf128_ps(rows[3], 1), first + 4 * kTransformStride + c * 4);
+		}
+
+		// cross products of the model columns a0 = m0..2, a1 = m4..6, a2 = m8..10
+		__m256 normal[3][3];
+		normal[0][0] = _mm256_sub_ps(_mm256_mul_ps(m[5], m[10]), _mm256_mul_ps(m[6], m[9])); // a1 x a2
+		normal[0][1] = _mm256_sub_ps(_mm256_mul_ps(m[6], m[8]), _mm256_mul_ps(m[4], m[10]));
+		normal[0][2] = _mm256_sub_ps(_mm256_mul_ps(m[4], m[9]), _mm256_mul_ps(m[5], m[8]));
+		normal[1][0] = _mm256_sub_ps(_mm256_mul_ps(m[9], m[2]), _mm256_mul_ps(m[10], m[1])); // a2 x a0
+		normal[1][1] = _mm256_sub_ps(_mm256_mul_ps(m[10], m[0]), _mm256_mul_ps(m[8], m[2]));
+		normal[1][2] = _mm256_sub_ps(_mm256_mul_ps(m[8], m[1]), _mm256_mul_ps(m[9], m[0]));
+		normal[2][0] = _mm256_sub_ps(_mm256_mul_ps(m[1], m[6]), _mm256_mul_ps(m[2], m[5])); // a0 x a1
+		normal[2][1] = _mm256_sub_ps(_mm256_mul_ps(m[2], m[4]), _mm256_mul_ps(m[0], m[6]));
+		normal[2][2] = _mm256_sub_ps(_mm256_mul_ps(m[0], m[5]), _mm256_mul_ps(m[1], m[4]));
+		__m256 determinant = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m[0], normal[0][0]), _mm256_mul_ps(m[1], normal[0][1])), _mm256_mul_ps(m[2], normal[0][2]));
+		__m256 inverseDeterminant = _mm256_div_ps(_mm256_set1_ps(1.0f), determinant); // a full divide, rcp would show in the lighting
+		for (int c = 0; c < 3; c++) {
+			__m256 x = _mm256_mul_ps(normal[c][0], inverseDeterminant);
+			__m256 y = _mm256_mul_ps(normal[c][1], inverseDeterminant);
+			__m256 z = _mm256_mul_ps(normal[c][2], inverseDeterminant);
+			float* column = first + 16 + c * 4;
+			StoreColumn4(_mm256_castps256_ps128(x), _mm256_castps256_ps128(y), _mm256_castps256_ps128(z), _mm_setzero_ps(), column);
+			StoreColumn4(_mm256_extractf128_ps(x, 1), _mm256_extractf128_ps(y, 1), _mm256_extractf128_ps(z, 1), _mm_setzero_ps(), column + 4 * kTransformStride);
+		}
+	}
+#elif defined(TRANSFORM_BATCH_SSE2)
+	for (; i + 4 <= count; i += 4) {
+		__m128 m[16];
+		for (int e = 0; e < 16; e++) {
+			m[e] = _mm_loadu_ps(&elements[e][i]);
+		}
+		float* first = &transforms[i].mvp[0][0];
+
+		for (int c = 0; c < 4; c++) { // mvp[c][r] = sum over k of viewProjection[k][r] * model[c][k]
+			__m128 rows[4];
+			for (int r = 0; r < 4; r++) {
+				rows[r] = _mm_add_ps(
+					_mm_add_ps(_mm_mul_ps(_mm_set1_ps(viewProjection[0][r]), m[c * 4]), _mm_mul_ps(_mm_set1_ps(viewProjection[1][r]), m[c * 4 + 1])),
+					_mm_add_ps(_mm_mul_ps(_mm_set1_ps(viewProjection[2][r]), m[c * 4 + 2]), _mm_mul_ps(_mm_set1_ps(viewProjection[3][r]), m[c * 4 + 3])));
+			}
+			StoreColumn4(rows[0], rows[1], rows[2], rows[3], first + c * 4);
+		}
+
+		// cross products of the model columns a0 = m0..2, a1 = m4..6, a2 = m8..10
+		__m128 normal[3][3];
+		normal[0][0] = _mm_sub_ps(_mm_mul_ps(m[5], m[10]), _mm_mul_ps(m[6], m[9])); // a1 x a2
+		normal[0][1] = _mm_sub_ps(_mm_mul_ps(m[6], m[8]), _mm_mul_ps(m[4], m[10]));
+		normal[0][2] = _mm_sub_ps(_mm_mul_ps(m[4], m[9]), _mm_mul_ps(m[5], m[8]));
+		normal[1][0] = _mm_sub_ps(_mm_mul_ps(m[9], m[2]), _mm_mul_ps(m[10], m[1])); // a2 x a0
+		normal[1][1] = _mm_sub_ps(_mm_mul_ps(m[10], m[0]), _mm_mul_ps(m[8], m[2]));
+		normal[1][2] = _mm_sub_ps(_mm_mul_ps(m[8], m[1]), _mm_mul_ps(m[9], m[0]));
+		normal[2][0] = _mm_sub_ps(_mm_mul_ps(m[1], m[6]), _mm_mul_ps(m[2], m[5])); // a0 x a1
+		normal[2][1] = _mm_sub_ps(_mm_mul_ps(m[2], m[4]), _mm_mul_ps(m[0], m[6]));
+		normal[2][2] = _mm_sub_ps(_mm_mul_ps(m[0], m[5]), _mm_mul_ps(m[1], m[4]));
+		__m128 determinant = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m[0], normal[0][0]), _mm_mul_ps(m[1], normal[0][1])), _mm_mul_ps(m[2], normal[0][2]));
+		__m128 inverseDeterminant = _mm_div_ps(_mm_set1_ps(1.0f), determinant); // a full divide, rcp would show in the lighting
+		for (int c = 0; c < 3; c++) {
+			StoreColumn4(_mm_mul_ps(normal[c][0], inverseDeterminant), _mm_mul_ps(normal[c][1], inverseDeterminant), _mm_mul_ps(normal[c][2], inverseDeterminant),
+				_mm_setzero_ps(), first + 16 + c * 4);
+		}
+	}
+#endif
+	for (; i < count; i++) { // scalar tail and fallback
+		glm::mat4 model;
+		for (int e = 0; e < 16; e++) {
+			model[e / 4][e % 4] = elements[e][i];
+		}
+		transforms[i] = MakeObjectTransform(model, viewProjection);
+	}
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <vector>
+
+#ifndef  TransformBatch_h
+#define TransformBatch_h
+
+// per object matrices of a frame, the vertex shaders only multiply the vertex with them
+struct ObjectTransform {
+	glm::mat4 mvp; // projection * view * model
+	glm::vec4 normalMatrix[3]; // inverse transpose of the upper 3x3 of model, mat3 columns padded to vec4 like std430 does
+};
+
+// MVP and normal matrix of a single model matrix, the scalar path of TransformBatch
+ObjectTransform MakeObjectTransform(const glm::mat4& model, const glm::mat4& viewProjection);
+
+// computes the MVP and normal matrix of every object of a frame in one pass. Model matrices are kept structure of arrays
+// so 8 objects go through per AVX2 iteration (4 with SSE2), the inverse transpose is the cofactor matrix over the determinant
+class TransformBatch {
+public:
+	std::vector<ObjectTransform> transforms; // valid after Compute, in Add order
+	TransformBatch();
+	void Clear(); // drops every object, keeps the memory for the next frame
+	unsigned int Add(const glm::mat4& model); // returns the index into transforms
+	void Compute(const glm::mat4& viewProjection); // projection * view of the frame
+private:
+	std::vector<float> elements[16]; // element [column * 4 + row] of every model matrix
+};
+
+#endif /TransformBatch_h/
@@ -0,0 +1,10 @@
+#include "VertexBufferWriter.h"
+
+void AllocateVertexStorage(GLsizeiptr size) {
+	if (GLEW_ARB_buffer_storage) {
+		glBufferStorage(GL_ARRAY_BUFFER, size, nullptr, GL_MAP_WRITE_BIT | GL_DYNAMIC_STORAGE_BIT); // immutable, the driver can place it in video memory right away. Dynamic so the staging fallback of WriteVertexBuffer may glBufferSubData
+	}
+	else {
+		glBufferData(GL_ARRAY_BUFFER, size, nullptr, GL_STATIC_DRAW);
+	}
+}
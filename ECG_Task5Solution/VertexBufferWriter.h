@@ -0,0 +1,40 @@
+#pragma once
+#include <GL\glew.h>
+#include <vector>
+#include <cstddef>
+
+#ifndef  VertexBufferWriter_h
+#define VertexBufferWriter_h
+
+const int kMaxVertexMapAttempts = 3; // mappings whose contents were lost before WriteVertexBuffer stages the data instead
+
+// allocates "size" bytes of write-only storage for the bound GL_ARRAY_BUFFER
+// (immutable glBufferStorage if ARB_buffer_storage is available, glBufferData otherwise), glBufferSubData stays legal on it
+void AllocateVertexStorage(GLsizeiptr size);
+
+// allocates "floatCount" floats for the bound GL_ARRAY_BUFFER and lets "generate(float* out)" write the
+// vertices straight into the mapped buffer, so no CPU side copy of the mesh is ever built
+template <typename Generator>
+void WriteVertexBuffer(size_t floatCount, Generator generate) {
+	GLsizeiptr size = floatCount * sizeof(float);
+	AllocateVertexStorage(size);
+
+	for (int attempt = 0; attempt < kMaxVertexMapAttempts; attempt++) {
+		float* out = (float*)glMapBufferRange(GL_ARRAY_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+		if (out == nullptr) { // mapping failed, go through a temporary copy instead
+			break;
+		}
+
+		generate(out);
+		if (glUnmapBuffer(GL_ARRAY_BUFFER) == GL_TRUE) {
+			return;
+		}
+		// the buffer contents were lost while mapped (e.g. on a display mode change), write them again
+	}
+
+	std::vector<float> staging(floatCount);
+	generate(&staging[0]);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, size, &staging[0]);
+}
+
+#endif /VertexBufferWriter_h/
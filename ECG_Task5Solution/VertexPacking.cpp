@@ -0,0 +1,138 @@
+#include "VertexPacking.h"
+#include <cmath>
+
+VertexQuantization::VertexQuantization() {
+	packed = false;
+	positionOffset = glm::vec3(0.0f, 0.0f, 0.0f);
+	positionScale = glm::vec3(1.0f, 1.0f, 1.0f);
+	uvOffset = glm::vec2(0.0f, 0.0f);
+	uvScale = glm::vec2(1.0f, 1.0f);
+}
+
+// float in [-1, 1] to snorm16
+static short PackSnorm16(float value) {
+	value = value < -1.0f ? -1.0f : value > 1.0f ? 1.0f : value;
+	return (short)std::floor(value * 32767.0f + 0.5f);
+}
+
+// float in [0, 1] to unorm16
+static unsigned short PackUnorm16(float value) {
+	value = value < 0.0f ? 0.0f : value > 1.0f ? 1.0f : value;
+	return (unsigned short)std::floor(value * 65535.0f + 0.5f);
+}
+
+static float SignNotZero(float value) {
+	return value >= 0.0f ? 1.0f : -1.0f;
+}
+
+// maps a direction onto the octahedron and unfolds it into the [-1, 1] square
+static void EncodeOctahedral(float x, float y, float z, short* out) {
+	float l1 = std::abs(x) + std::abs(y) + std::abs(z);
+	if (l1 == 0.0f) { // degenerate normal, store +z
+		out[0] = 0;
+		out[1] = 0;
+		return;
+	}
+
+	float u = x / l1;
+	float v = y / l1;
+	if (z < 0.0f) { // fold the lower hemisphere over the diagonals
+		float foldedU = (1.0f - std::abs(v)) * SignNotZero(u);
+		float foldedV = (1.0f - std::abs(u)) * SignNotZero(v);
+		u = foldedU;
+		v = foldedV;
+	}
+
+	out[0] = PackSnorm16(u);
+	out[1] = PackSnorm16(v);
+}
+
+std::vector<PackedVertex> PackVertices(const float* data, size_t vertexCount, VertexQuantization& quantization) {
+	std::vector<PackedVertex> packed(vertexCount);
+	if (vertexCount == 0) {
+		return packed;
+	}
+
+	// bounds of positions and uvs
+	glm::vec3 minPosition(data[0], data[1], data[2]);
+	glm::vec3 maxPosition = minPosition;
+	glm::vec2 minUv(data[6], data[7]);
+	glm::vec2 maxUv = minUv;
+	for (size_t i = 1; i < vertexCount; i++) {
+		const float* vertex = &data[i * 8];
+		minPosition = glm::min(minPosition, glm::vec3(vertex[0], vertex[1], vertex[2]));
+		maxPosition = glm::max(maxPosition, glm::vec3(vertex[0], vertex[1], vertex[2]));
+		minUv = glm::min(minUv, glm::vec2(vertex[6], vertex[7]));
+		maxUv = glm::max(maxUv, glm::vec2(vertex[6], vertex[7]));
+	}
+
+	quantization.packed = true;
+	quantization.positionOffset = (minPosition + maxPosition) * 0.5f;
+	quantization.positionScale = (maxPosition - minPosition) * 0.5f;
+	quantization.uvOffset = minUv;
+	quantization.uvScale = maxUv - minUv;
+	for (int k = 0; k < 3; k++) { // flat axes would divide by zero
+		if (quantization.positionScale[k] == 0.0f) {
+			quantization.positionScale[k] = 1.0f;
+		}
+	}
+	for (int k = 0; k < 2; k++) {
+		if (quantization.uvScale[k] == 0.0f) {
+			quantization.uvScale[k] = 1.0f;
+		}
+	}
+
+	for (size_t i = 0; i < vertexCount; i++) {
+		const float* vertex = &data[i * 8];
+		PackedVertex& out = packed[i];
+
+		for (int k = 0; k < 3; k++) {
+			out.position[k] = PackSnorm16((vertex[k] - quantization.positionOffset[k]) / quantization.positionScale[k]);
+		}
+		out.position[3] = 0;
+
+		EncodeOctahedral(vertex[3], vertex[4], vertex[5], out.normal);
+
+		for (int k = 0; k < 2; k++) {
+			out.uv[k] = PackUnorm16((vertex[6 + k] - quantization.uvOffset[k]) / quantization.uvScale[k]);
+		}
+	}
+
+	return packed;
+}
+
+void UploadVertices(const float* data, size_t vertexCount, bool packed, VertexQuantization& quantization) {
+	if (packed) {
+		std::vector<PackedVertex> packedVertices = PackVertices(data, vertexCount, quantization);
+		glBufferData(GL_ARRAY_BUFFER, packedVertices.size() * sizeof(PackedVertex), &packedVertices[0], GL_STATIC_DRAW);
+	}
+	else {
+		quantization = VertexQuantization();
+		glBufferData(GL_ARRAY_BUFFER, vertexCount * 8 * sizeof(float), data, GL_STATIC_DRAW);
+	}
+	SetVertexLayout(packed);
+}
+
+void SetVertexLayout(bool packed) {
+	if (packed) {
+		GLsizei stride = sizeof(PackedVertex);
+		glEnableVertexAttribArray(0); // position, decoded with positionOffset/positionScale
+		glVertexAttribPointer(0, 3, GL_SHORT, GL_TRUE, stride, (void*)offsetof(PackedVertex, position));
+
+		glEnableVertexAttribArray(1); // octahedral normal, decoded by the shader
+		glVertexAttribPointer(1, 2, GL_SHORT, GL_TRUE, stride, (void*)offsetof(PackedVertex, normal));
+
+		glEnableVertexAttribArray(2); // uv, decoded with uvOffset/uvScale
+		glVertexAttribPointer(2, 2, GL_UNSIGNED_SHORT, GL_TRUE, stride, (void*)offsetof(PackedVertex, uv));
+	}
+	else {
+		glEnableVertexAttribArray(0); // position attribute
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), 0);
+
+		glEnableVertexAttribArray(1); // normal attribute
+		glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
+
+		glEnableVertexAttribArray(2); // texture coord attribute
+		glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
+	}
+}
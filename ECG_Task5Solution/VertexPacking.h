@@ -0,0 +1,38 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <vector>
+#include <cstddef>
+#include <GL\glew.h>
+
+#ifndef  VertexPacking_h
+#define VertexPacking_h
+
+// compact 16 byte vertex, replaces the 32 byte position/normal/uv float layout
+struct PackedVertex {
+	short position[4]; // snorm16 position relative to the mesh bounds, w is padding
+	short normal[2]; // octahedral encoded unit normal, snorm16
+	unsigned short uv[2]; // unorm16 uv relative to the mesh uv bounds
+};
+
+// parameters the vertex shaders need to decode a packed mesh (identity for float meshes)
+class VertexQuantization {
+public:
+	bool packed; // true if the vertex buffer holds PackedVertex entries
+	glm::vec3 positionOffset; // center of the mesh bounds
+	glm::vec3 positionScale; // half extent of the mesh bounds
+	glm::vec2 uvOffset; // minimum uv of the mesh
+	glm::vec2 uvScale; // uv range of the mesh
+	VertexQuantization(); // float layout
+};
+
+// packs "vertexCount" interleaved position/normal/uv float vertices, filling in the decode parameters
+std::vector<PackedVertex> PackVertices(const float* data, size_t vertexCount, VertexQuantization& quantization);
+
+// buffers "vertexCount" interleaved position/normal/uv float vertices into the bound GL_ARRAY_BUFFER
+// (packed if requested) and sets the matching attribute layout on the bound VAO
+void UploadVertices(const float* data, size_t vertexCount, bool packed, VertexQuantization& quantization);
+
+// sets the attribute layout of the bound VAO for a GL_ARRAY_BUFFER of float or packed vertices
+void SetVertexLayout(bool packed);
+
+#endif /VertexPacking_h/
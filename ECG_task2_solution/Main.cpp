@@ -16,6 +16,9 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <vector>
+#include <map>
+#include <array>
+#include <cstring>
 
 class OrbitalCamera {
 public:
@@ -60,6 +63,203 @@ Teapot::Teapot(glm::mat4 _model, double _r, double _g, double _b, double _a) { /
 	a = _a;
 }
 
+struct TeapotInstance { // per instance data as laid out in the instance buffer
+	glm::mat4 model; // attribute locations 2 to 5
+	glm::vec4 color; // attribute location 1
+};
+
+class TeapotInstanceRenderer { // draws every teapot of a list with one glDrawElementsInstanced call
+public:
+	GLuint Vao; // teapot mesh plus instance attributes
+	GLuint Vbo; // welded teapot positions
+	GLuint Ebo; // teapot triangle indices
+	GLuint InstanceVbo; // one TeapotInstance per teapot
+	GLsizei indexCount; // indices of the teapot mesh
+	GLsizei instanceCapacity; // teapots the instance buffer has room for
+	std::vector<TeapotInstance> uploaded; // copy of the instance buffer content, to find the changed teapots
+	GLsizei instancesUploaded; // instances written by the last Update
+	TeapotInstanceRenderer(const char* capturePath); // records the framework teapot with the given capture vertex shader
+	void Update(const std::vector<Teapot>& teapots); // writes the instances whose model or color changed
+	void Draw(); // draws all instances with the bound program
+	void Release(); // deletes the GL objects
+};
+
+// drawTeapot() belongs to the framework and hides its VAO, so the teapot is recorded once through transform feedback
+// and welded back into an indexed mesh that can be drawn instanced
+TeapotInstanceRenderer::TeapotInstanceRenderer(const char* capturePath) {
+	std::ifstream is_vs(capturePath); // read shader file
+	const std::string f_vs((std::istreambuf_iterator<char>(is_vs)), std::istreambuf_iterator<char>()); // string buffer
+	const char* captureSource = f_vs.c_str();
+	GLuint captureShader = glCreateShader(GL_VERTEX_SHADER); // Create an empty vertex shader handle
+	glShaderSource(captureShader, 1, &captureSource, 0); // link source
+	glCompileShader(captureShader); // Compile the vertex shader
+
+	// Check for capture vs errors
+	GLint succeded_vs;
+	glGetShaderiv(captureShader, GL_COMPILE_STATUS, &succeded_vs);
+	if (succeded_vs == GL_FALSE) {
+		GLint logSize;
+		glGetShaderiv(captureShader, GL_INFO_LOG_LENGTH, &logSize);
+		GLchar* message = new char[logSize];
+		glGetShaderInfoLog(captureShader, logSize, NULL, message);
+		std::cerr << message;
+		delete[] message;
+	}
+
+	GLuint captureProgram = glCreateProgram(); // vertex shader only, nothing is rasterized
+	glAttachShader(captureProgram, captureShader);
+	const char* varyings[] = { "capturedPosition" };
+	glTransformFeedbackVaryings(captureProgram, 1, varyings, GL_INTERLEAVED_ATTRIBS); // has to be set before linking
+	glLinkProgram(captureProgram);
+
+	// Check for capture program errors, without a program nothing is captured and the mesh stays empty
+	GLint linked;
+	glGetProgramiv(captureProgram, GL_LINK_STATUS, &linked);
+	if (linked == GL_FALSE) {
+		GLint logSize;
+		glGetProgramiv(captureProgram, GL_INFO_LOG_LENGTH, &logSize);
+		GLchar* message = new char[logSize];
+		glGetProgramInfoLog(captureProgram, logSize, NULL, message);
+		std::cerr << message;
+		delete[] message;
+	}
+
+	std::vector<float> triangles; // captured triangle list, 3 positions per triangle
+	if (linked != GL_FALSE) {
+		glUseProgram(captureProgram);
+		glEnable(GL_RASTERIZER_DISCARD);
+
+		// first pass counts the triangles to size the capture buffer
+		GLuint query;
+		GLuint triangleCount = 0;
+		glGenQueries(1, &query);
+		glBeginQuery(GL_PRIMITIVES_GENERATED, query);
+		drawTeapot();
+		glEndQuery(GL_PRIMITIVES_GENERATED);
+		glGetQueryObjectuiv(query, GL_QUERY_RESULT, &triangleCount);
+		glDeleteQueries(1, &query);
+
+		// second pass writes the triangle list
+		GLuint captureBuffer;
+		glGenBuffers(1, &captureBuffer);
+		glBindBuffer(GL_TRANSFORM_FEEDBACK_BUFFER, captureBuffer);
+		glBufferData(GL_TRANSFORM_FEEDBACK_BUFFER, triangleCount * 3 * 3 * sizeof(float), nullptr, GL_STATIC_READ);
+		glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, captureBuffer);
+		glBeginTransformFeedback(GL_TRIANGLES);
+		drawTeapot();
+		glEndTransformFeedback();
+		glDisable(GL_RASTERIZER_DISCARD);
+
+		triangles.resize(triangleCount * 3 * 3);
+		if (!triangles.empty()) {
+			glGetBufferSubData(GL_TRANSFORM_FEEDBACK_BUFFER, 0, triangles.size() * sizeof(float), &triangles[0]);
+		}
+		glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+		glBindBuffer(GL_TRANSFORM_FEEDBACK_BUFFER, 0);
+		glDeleteBuffers(1, &captureBuffer);
+		glUseProgram(0);
+	}
+	glDetachShader(captureProgram, captureShader);
+	glDeleteProgram(captureProgram);
+	glDeleteShader(captureShader);
+
+	// weld identical positions, the teapot shader uses nothing else
+	std::map<std::array<float, 3>, unsigned int> vertexIndex;
+	std::vector<float> positions;
+	std::vector<unsigned int> indices;
+	for (size_t i = 0; i < triangles.size(); i += 3) {
+		std::array<float, 3> position = { triangles[i], triangles[i + 1], triangles[i + 2] };
+		std::map<std::array<float, 3>, unsigned int>::iterator it = vertexIndex.find(position);
+		if (it == vertexIndex.end()) {
+			it = vertexIndex.insert(std::make_pair(position, (unsigned int)(positions.size() / 3))).first;
+			positions.insert(positions.end(), position.begin(), position.end());
+		}
+		indices.push_back(it->second);
+	}
+	indexCount = (GLsizei)indices.size();
+
+	glGenVertexArrays(1, &Vao); // create the VAO
+	glBindVertexArray(Vao);
+
+	glGenBuffers(1, &Vbo); // teapot positions at location 0
+	glBindBuffer(GL_ARRAY_BUFFER, Vbo);
+	glBufferData(GL_ARRAY_BUFFER, positions.size() * sizeof(float), positions.empty() ? nullptr : &positions[0], GL_STATIC_DRAW);
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), 0);
+
+	glGenBuffers(1, &Ebo); // bind the EBO to the VAO
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, Ebo);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.empty() ? nullptr : &indices[0], GL_STATIC_DRAW);
+
+	glGenBuffers(1, &InstanceVbo); // instance attributes advance once per teapot
+	glBindBuffer(GL_ARRAY_BUFFER, InstanceVbo);
+	glEnableVertexAttribArray(1);
+	glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(TeapotInstance), (void*)offsetof(TeapotInstance, color));
+	glVertexAttribDivisor(1, 1);
+	for (int column = 0; column < 4; column++) { // a mat4 attribute takes one location per column
+		glEnableVertexAttribArray(2 + column);
+		glVertexAttribPointer(2 + column, 4, GL_FLOAT, GL_FALSE, sizeof(TeapotInstance), (void*)(offsetof(TeapotInstance, model) + column * sizeof(glm::vec4)));
+		glVertexAttribDivisor(2 + column, 1);
+	}
+
+	glBindVertexArray(0); // unbind the VAO
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	instanceCapacity = 0;
+	instancesUploaded = 0;
+}
+
+// the parameter "teapots" specifies the teapots to draw, only runs of changed teapots are written to the instance buffer
+void TeapotInstanceRenderer::Update(const std::vector<Teapot>& teapots) {
+	instancesUploaded = 0;
+	glBindBuffer(GL_ARRAY_BUFFER, InstanceVbo);
+
+	if ((GLsizei)teapots.size() > instanceCapacity) { // grow, everything has to be written again
+		instanceCapacity = (GLsizei)teapots.size() * 2;
+		glBufferData(GL_ARRAY_BUFFER, instanceCapacity * sizeof(TeapotInstance), nullptr, GL_DYNAMIC_DRAW);
+		uploaded.clear();
+	}
+
+	size_t previousCount = uploaded.size();
+	uploaded.resize(teapots.size());
+	size_t runStart = teapots.size(); // first teapot of the current run of changed teapots
+	for (size_t i = 0; i <= teapots.size(); i++) {
+		bool changed = false;
+		if (i < teapots.size()) {
+			const Teapot& teapot = teapots[i];
+			TeapotInstance instance;
+			instance.model = teapot.model;
+			instance.color = glm::vec4((float)teapot.r, (float)teapot.g, (float)teapot.b, (float)teapot.a);
+			changed = i >= previousCount || memcmp(&instance, &uploaded[i], sizeof(TeapotInstance)) != 0;
+			if (changed) {
+				uploaded[i] = instance;
+			}
+		}
+
+		if (changed && runStart == teapots.size()) {
+			runStart = i;
+		}
+		else if (!changed && runStart != teapots.size()) { // run ended, write it with one call
+			glBufferSubData(GL_ARRAY_BUFFER, runStart * sizeof(TeapotInstance), (i - runStart) * sizeof(TeapotInstance), &uploaded[runStart]);
+			instancesUploaded += (GLsizei)(i - runStart);
+			runStart = teapots.size();
+		}
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void TeapotInstanceRenderer::Draw() {
+	glBindVertexArray(Vao);
+	glDrawElementsInstanced(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, 0, (GLsizei)uploaded.size());
+	glBindVertexArray(0);
+}
+
+void TeapotInstanceRenderer::Release() {
+	glDeleteBuffers(1, &Vbo);
+	glDeleteBuffers(1, &Ebo);
+	glDeleteBuffers(1, &InstanceVbo);
+	glDeleteVertexArrays(1, &Vao);
+}
+
 struct Vectors { // Shorthand representation of WORLD 3D vectors in this engine
 	glm::vec3 UP = glm::vec3(0.0f, 1.0f, 0.0f);
 	glm::vec3 DOWN = glm::vec3(0.0f, -1.0f, 0.0f);
@@ -286,6 +486,11 @@ int main(int argc, char** argv)
 	teapotList[1].model = glm::rotate(teapotList[1].model, (float) DegreesToRadians(45.0), glm::vec3(0.0f, 0.0f, 1.0f)); // rotate teapot2 along the positive Z axis
 	teapotList[1].model = glm::translate(teapotList[1].model, glm::vec3(1.5f, 1.0f, 0.0f)); // trranslate teapot2
 
+	TeapotInstanceRenderer teapotRenderer("assets/teapotCapture.vert"); // all teapots in one instanced draw
+
+	GLint uniView = glGetUniformLocation(shaderProgram, "view"); // get uniform ID for view matrix
+	GLint uniProj = glGetUniformLocation(shaderProgram, "proj"); // get uniform ID for projection matrix 
+
 
 	while (!glfwWindowShouldClose(window)) // render loop
 	{
@@ -388,21 +593,12 @@ int main(int argc, char** argv)
 
 			glUseProgram(shaderProgram); // Load the shader into the rendering pipeline 
 
-			GLint uniView = glGetUniformLocation(shaderProgram, "view"); // get uniform ID for view matrix
-			GLint uniProj = glGetUniformLocation(shaderProgram, "proj"); // get uniform ID for projection matrix 
-			GLint uniModel = glGetUniformLocation(shaderProgram, "model"); // get uniform ID for model matrix
-			GLint location = glGetUniformLocation(shaderProgram, "outColor"); // get uniform ID for out-color vector
-
 			glUniformMatrix4fv(uniView, 1, GL_FALSE, glm::value_ptr(view)); // push view to shader
 			glUniformMatrix4fv(uniProj, 1, GL_FALSE, glm::value_ptr(mainCamera.projectionMatrix)); // push projection to shader
 
 
-			for each (Teapot teapot in teapotList) // render all teapots
-			{
-				glUniform4f(location, teapot.r, teapot.g, teapot.b, teapot.a); // push color to shader
-				glUniformMatrix4fv(uniModel, 1, GL_FALSE, glm::value_ptr(teapot.model)); // push teapot1 model to shader
-				drawTeapot(); // draw the teapots VAO/VBO
-			}
+			teapotRenderer.Update(teapotList); // write the teapots that changed since the last frame
+			teapotRenderer.Draw(); // render all teapots
 
 			glfwSwapBuffers(window); // swap buffer
 		}
@@ -417,6 +613,7 @@ int main(int argc, char** argv)
 	glDeleteProgram(shaderProgram);
 	glDeleteShader(vertexShader);
 	glDeleteShader(fragmentShader);
+	teapotRenderer.Release();
 	destroyFramework(); // destroy framework
 	glfwDestroyWindow(window);
 	glfwTerminate();
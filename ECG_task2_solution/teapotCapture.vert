@@ -0,0 +1,11 @@
+//vertex shader, only used once at startup to record the framework teapot through transform feedback
+#version 430 
+
+layout (location = 0) in vec3 aPos; // the position variable has attribute position 0
+
+out vec3 capturedPosition; // written to the transform feedback buffer
+
+void main()
+{
+    capturedPosition = aPos;
+}
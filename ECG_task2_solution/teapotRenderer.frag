@@ -2,9 +2,9 @@
 #version 430
 out vec4 FragColor;
   
-uniform vec4 outColor; // we set this variable in the OpenGL code.
+in vec4 vertexColor; // color of the teapot instance, from the vertex shader
 
 void main()
 {
-    FragColor = outColor;
+    FragColor = vertexColor;
 }
@@ -2,15 +2,16 @@
 #version 430 
 
 layout (location = 0) in vec3 aPos; // the position variable has attribute position 0
+layout (location = 1) in vec4 instanceColor; // per teapot color, advances once per instance
+layout (location = 2) in mat4 instanceModel; // per teapot model matrix, occupies locations 2 to 5
 
 out vec4 vertexColor; // specify a color output to the fragment shader
 
 uniform mat4 proj;
 uniform mat4 view;
-uniform mat4 model;
 
 void main()
 {
-    gl_Position = proj * view * model * vec4(aPos, 1.0); // position
-    vertexColor = vec4(1.0, 1.0, 1.0, 1.0); // default color white
+    gl_Position = proj * view * instanceModel * vec4(aPos, 1.0); // position
+    vertexColor = instanceColor; // color of the teapot instance
 }